@@ -8,6 +8,7 @@
 #include <fstream>
 
 #include "pqueue.h"
+#include "radix_heap.h"
 
 using std::string;
 using std::vector;
@@ -191,6 +192,13 @@ class graph {
     //   to detect if an edge already exists efficiently.
     unordered_set<string> edges;
 
+    // integral_weights:
+    //   true as long as every edge weight added so far is a non-negative
+    //   integer (small enough to be held exactly in a double).  When
+    //   set, dijkstraHEAP runs on a radix heap instead of pqueue.
+    //   See dijkstraRADIX.
+    bool integral_weights = true;
+
   public:
 
     // this struct is used for capturing the results of an operation.
@@ -223,6 +231,18 @@ class graph {
         return id;
     }
 
+    /*
+     * function:  is_integral_weight
+     *
+     * true if w is a non-negative whole number no larger than 2^53
+     *   (beyond that not every integer is representable as a double).
+     */
+    static
+    bool is_integral_weight(double w) {
+      return w >= 0 && w <= 9007199254740992.0 &&
+        w == (double)(unsigned long long)w;
+    }
+
     /*
      * function:  edge_string
      *
@@ -370,6 +390,9 @@ class graph {
       vertices[s_id].outgoing.push_back(edge(d_id, weight));
       vertices[d_id].incoming.push_back(edge(s_id, weight));
 
+      if(!is_integral_weight(weight))
+        integral_weights = false;
+
       return true;
     }
 
@@ -513,6 +536,12 @@ class graph {
       return edges.size();
     }
 
+    // true if every edge weight read so far is a non-negative integer
+    //   (in which case dijkstraHEAP uses the radix heap).
+    bool has_integral_weights() {
+      return integral_weights;
+    }
+
   private:
     void init_report(std::vector<vertex_label> & report) {
       int u;
@@ -1166,7 +1195,78 @@ class graph {
     }
 
 
+    /*
+     * dijkstraHEAP: heap-based implementation of dijkstra.
+     *
+     *   if every edge weight is a non-negative integer (see
+     *   has_integral_weights), the work is handed to dijkstraRADIX;
+     *   otherwise the pqueue binary heap is used.
+     */
     bool dijkstraHEAP(int src, std::vector<vertex_label> &report) {
+      if(integral_weights)
+        return dijkstraRADIX(src, report);
+      return dijkstraPQ(src, report);
+    }
+
+    /*
+     * dijkstraRADIX: dijkstra on a radix heap (see radix_heap.h).
+     *
+     *   Only valid when every edge weight is a non-negative integer:
+     *   distances are then integers and extraction is monotone, so the
+     *   radix heap applies.  Returns false otherwise.
+     *
+     *   The radix heap has no change_priority; an improved distance is
+     *   inserted again, and when an older (larger) copy of a FINISHED
+     *   vertex comes off the heap it is skipped.
+     */
+    bool dijkstraRADIX(int src, std::vector<vertex_label> &report) {
+      int u, v;
+      unsigned long long d_u;
+      radix_heap q;
+
+      if(src < 0 || src >= num_nodes())
+        return false;
+      if(!integral_weights) {
+        std::cerr << " ERROR: dijkstraRADIX requires non-negative integer weights\n";
+        return false;
+      }
+
+      init_report(report);
+      report[src].dist = 0;
+
+      report[src].pred = src;
+      report[src].state = DISCOVERED;
+
+      q.insert(src, 0);
+
+      while(q.delete_top(u, d_u)) {
+
+          if(report[u].state == FINISHED)
+              continue;   // stale copy
+          report[u].state = FINISHED;
+
+          // examine outgoing edges of u
+          for(edge &e : vertices[u].outgoing) {
+              v = e.vertex_id;
+              unsigned long long dist = d_u + (unsigned long long)e.weight;
+
+              if(report[v].state == UNDISCOVERED || 
+                  (report[v].state == DISCOVERED && dist < report[v].dist)) {
+                  q.insert(v, dist);
+                  report[v].dist = dist;
+                  report[v].pred = u;
+                  report[v].state = DISCOVERED;
+              }
+          }
+      }
+      return true;
+    }
+
+    /*
+     * dijkstraPQ: dijkstra on the pqueue binary heap; works for any
+     *   non-negative weights.
+     */
+    bool dijkstraPQ(int src, std::vector<vertex_label> &report) {
       int u, v;
       double min_d;
       int next_vertex;
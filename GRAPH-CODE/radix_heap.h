@@ -0,0 +1,153 @@
+#include <vector>
+
+#ifndef RADIX_HEAP
+#define RADIX_HEAP
+
+/*
+ * class radix_heap
+ *
+ * A monotone min-priority queue for non-negative integer priorities
+ *   (as produced by dijkstra on an integer-weighted graph).
+ *
+ * "Monotone" means every inserted priority must be >= the priority
+ *   most recently returned by delete_top.  Dijkstra satisfies this
+ *   since a new tentative distance is always d_u + w >= d_u.
+ *
+ * Entries are kept in 65 buckets relative to 'last' (the last priority
+ *   extracted):  bucket 0 holds priorities equal to last; bucket i > 0
+ *   holds priorities whose highest bit differing from last is bit i-1.
+ *   When bucket 0 runs dry, the first non-empty bucket is redistributed
+ *   around its minimum, and every entry lands in a strictly lower bucket.
+ *   An entry therefore moves at most 64 times over its life, giving
+ *   amortized O(log C) delete_top (C = largest priority) with no
+ *   comparisons between entries at all; insert is O(1).
+ *
+ * There is no change_priority:  a caller that improves an id's priority
+ *   simply inserts it again and skips the stale copy when it surfaces.
+ */
+class radix_heap {
+
+    private:
+        struct rh_entry {
+            unsigned long long priority;
+            int id;
+        };
+
+        static const int NBUCKETS = 65;
+
+        std::vector<rh_entry> buckets[NBUCKETS];
+        unsigned long long last;
+        int _size;
+
+        /*
+         * Function: bucket_of
+         * Desc:     index of the bucket that priority p belongs in
+         *             relative to the current value of last.
+         * Runtime:  O(1)
+         */
+        int bucket_of(unsigned long long p) {
+            unsigned long long diff = p ^ last;
+
+            if(diff == 0)
+                return 0;
+#if defined(__GNUC__)
+            return 64 - __builtin_clzll(diff);
+#else
+            int b = 0;
+            while(diff != 0) {
+                diff >>= 1;
+                b++;
+            }
+            return b;
+#endif
+        }
+
+        /*
+         * Function: refill
+         * Desc:     called when bucket 0 is empty (and the heap is not):
+         *             advances last to the smallest queued priority and
+         *             redistributes the bucket holding it.
+         * Runtime:  O(size of that bucket) -- amortized as above.
+         */
+        void refill() {
+            int i = 1;
+
+            while(buckets[i].empty())
+                i++;
+
+            unsigned long long min_p = buckets[i][0].priority;
+            for(rh_entry &e : buckets[i]) {
+                if(e.priority < min_p)
+                    min_p = e.priority;
+            }
+            last = min_p;
+
+            for(rh_entry &e : buckets[i])
+                buckets[bucket_of(e.priority)].push_back(e);
+            buckets[i].clear();
+        }
+
+    public:
+
+        /**
+         * CONSTRUCTOR
+         * Desc: creates an empty queue.  The first priority inserted
+         *       may be any non-negative value.
+         */
+        radix_heap() : last { 0 }, _size { 0 } { }
+
+        /**
+         * Function: insert
+         * Parameters: id of entry to insert
+         *             priority of entry to insert
+         * Returns: true on success; false if priority is below the
+         *          last priority extracted (monotonicity violated).
+         *
+         * Desc: the same id may be inserted more than once.
+         *
+         * Runtime:  O(1)
+         */
+        bool insert(int id, unsigned long long priority) {
+            if(priority < last)
+                return false;
+
+            buckets[bucket_of(priority)].push_back(rh_entry { priority, id });
+            _size++;
+            return true;
+        }
+
+        /**
+         * Function: delete_top
+         * Parameters: id and priority ("out" parameters)
+         * Returns: true on success; false on failure (empty queue)
+         * Desc: removes an entry with minimum priority and reports it.
+         *
+         * Runtime:  amortized O(log C)
+         */
+        bool delete_top(int &id, unsigned long long &priority) {
+            if(_size == 0)
+                return false;
+
+            if(buckets[0].empty())
+                refill();
+
+            id = buckets[0].back().id;
+            priority = last;
+            buckets[0].pop_back();
+            _size--;
+            return true;
+        }
+
+        /**
+         * Function: size
+         * Returns: number of entries currently in queue (stale
+         *          duplicates included)
+         *
+         * Runtime:  O(1)
+         */
+        int size() {
+            return _size;
+        }
+};
+
+#endif
@@ -0,0 +1,507 @@
+#include "engine.h"
+#include "graph.h"
+#include "graph_io.h"
+#include "graphgen.h"
+#include "parallel_pareto.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Benchmark harness for the point-to-point engines (make bench).
+//
+// Each case is one graph and one engine. It runs in a forked child, so the
+// peak RSS the kernel reports for the child is the case's own. The graphs
+// are the sample input.txt, GRAPH-CODE/g1000.g (whose single weight
+// becomes the cost, with times drawn against it), and seeded graphs of
+// each --topologies kind (see graphgen.h) and --sizes edge count. The
+// generated graphs have correlated, independent and anti-correlated cost
+// and time. Each anti-correlated one also gets a "-cheapest" case that
+// asks the dual query, the cheapest path within a time limit, on the
+// swapped graph as cpath --cheapest does.
+//
+// Queries are seeded too. Each picks a random source and takes as its
+// destination the --rank'th vertex a cost Dijkstra from it settles. The
+// budget is the cheapest cost there times 1 + --slack (a time limit from
+// the fastest time, in the dual cases). So a query's difficulty does not
+// grow with the graph, and every size is measured on the same kind of
+// query.
+//
+// Each case prints one JSON line with:
+//   - median and p99 query latency (each query's best of --repeats runs);
+//   - throughput in queries per second;
+//   - labels settled per second of search, counted from the label pools;
+//   - how many queries LARAC answered outright, settling no labels;
+//   - peak RSS;
+//   - a checksum of the answers.
+// With --baseline, the cases are compared to a saved run. A case whose
+// median or p99 got slower by more than --tolerance is flagged, and so is
+// one whose answers changed. Either makes the exit status 1.
+
+using Clock = chrono::steady_clock;
+
+// One benchmark graph: a name, how to build it, and whether its queries
+// are the dual (cheapest within a time limit)
+struct GraphCase {
+    string name;
+    function<bool(graph<int, int>&)> build;
+    bool cheapest = false;
+};
+
+// What a child measured, sent back to the parent over a pipe
+struct CaseResult {
+    bool ok = false;
+    size_t vertices = 0;
+    size_t edges = 0;
+    size_t queries = 0;
+    double medianMs = 0;
+    double p99Ms = 0;
+    double totalMs = 0;
+    double labels = 0;
+    size_t laracSolved = 0;
+    uint64_t checksum = 0;
+};
+
+struct BenchConfig {
+    vector<Engine> engines{Engine::LabelSetting, Engine::LowerBounded, Engine::Bidirectional, Engine::Parallel};
+    vector<Topology> topologies{Topology::Grid, Topology::Road, Topology::Geometric, Topology::PowerLaw};
+    vector<int64_t> sizes{10000, 100000, 1000000, 10000000}; // generated edge counts
+    int queries = 20;
+    int repeats = 3;
+    int rank = 4096;
+    double slack = 0.2;
+    uint64_t seed = 1;
+    int threads = max(1u, thread::hardware_concurrency());
+    string inputDir = ".";
+    string out;
+    string baseline;
+    double tolerance = 0.1;
+};
+
+struct Query {
+    int source;
+    int destination;
+    int budget;
+};
+
+// Seeded queries: the rank'th vertex a cost Dijkstra from a random source
+// settles (or its last, in a smaller component), with a budget slack above
+// the cheapest cost there. Sources that reach nothing are drawn again.
+vector<Query> make_queries(const graph<int, int> &g, const BenchConfig &config) {
+    int n = g.NumVertices();
+    vector<int64_t> dist(n, -1);
+    vector<int> touched;
+    using Entry = pair<int64_t, int>;
+    vector<Query> queries;
+    SplitMix64 rng(config.seed);
+    for (int attempt = 0; n > 0 && int(queries.size()) < config.queries && attempt < 100 * config.queries;
+         ++attempt) {
+        for (int v : touched) {
+            dist[v] = -1;
+        }
+        touched.clear();
+        int source = int(rng.uniform(0, n - 1));
+        priority_queue<Entry, vector<Entry>, greater<Entry>> pq;
+        dist[source] = 0;
+        touched.push_back(source);
+        pq.push({0, source});
+        int settled = 0;
+        Entry last{0, source};
+        while (!pq.empty() && settled <= config.rank) {
+            Entry top = pq.top();
+            pq.pop();
+            if (top.first > dist[top.second]) {
+                continue;
+            }
+            last = top;
+            ++settled;
+            for (const auto &edge : g.edges(top.second)) {
+                int64_t d = top.first + edge.cost;
+                if (dist[edge.target] < 0 || d < dist[edge.target]) {
+                    if (dist[edge.target] < 0) {
+                        touched.push_back(edge.target);
+                    }
+                    dist[edge.target] = d;
+                    pq.push({d, edge.target});
+                }
+            }
+        }
+        if (last.second != source) {
+            int budget = int(ceil(double(last.first) * (1 + config.slack)));
+            queries.push_back({source, last.second, budget});
+        }
+    }
+    return queries;
+}
+
+// Builds the graph and runs the engine's queries; in the child
+CaseResult run_case(const GraphCase &gc, Engine engine, const BenchConfig &bench) {
+    CaseResult result;
+    graph<int, int> g;
+    if (!gc.build(g)) {
+        return result;
+    }
+    if (gc.cheapest) {
+        g = g.swappedCriteria();
+    }
+    SearchConfig config;
+    config.engine = engine;
+    config.cheapest = gc.cheapest;
+    config.maxEdgeCost = g.maxEdgeCost();
+    config.window = labelWindow(g);
+    config.searchThreads = bench.threads;
+    vector<Query> queries = make_queries(g, bench);
+
+    // Each query's latency is its fastest of the repeats, which keeps
+    // scheduler and cache noise out of the comparison with a baseline
+    Workspace ws(g, config);
+    vector<double> latencies(queries.size(), numeric_limits<double>::max());
+    for (int round = 0; round < bench.repeats; ++round) {
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const Query &q = queries[i];
+            Clock::time_point start = Clock::now();
+            ConstrainedResult<int> r = constrained_query(g, ws, config, q.source, q.destination, q.budget);
+            latencies[i] = min(latencies[i], chrono::duration<double, milli>(Clock::now() - start).count());
+            if (round == 0) {
+                // A LARAC answer leaves only its path in the pool
+                if (ws.larac.solved) {
+                    ++result.laracSolved;
+                } else {
+                    result.labels += ws.forward.labels.size() + ws.backward.labels.size();
+                }
+                result.checksum =
+                    result.checksum * 1000003 + (r.found ? uint64_t(r.cost) * 65537 + r.time : 1);
+            }
+        }
+    }
+    result.ok = true;
+    result.vertices = g.NumVertices();
+    result.edges = g.NumEdges() / 2;
+    result.queries = latencies.size();
+    for (double ms : latencies) {
+        result.totalMs += ms;
+    }
+    if (!latencies.empty()) {
+        sort(latencies.begin(), latencies.end());
+        size_t n = latencies.size();
+        result.medianMs = n % 2 ? latencies[n / 2] : (latencies[n / 2 - 1] + latencies[n / 2]) / 2;
+        result.p99Ms = latencies[(n * 99 + 99) / 100 - 1];
+    }
+    return result;
+}
+
+// Runs one case in a forked child and fills in its peak RSS (in KiB)
+bool run_isolated(const GraphCase &gc, Engine engine, const BenchConfig &bench, CaseResult &result,
+                  long &peakRssKb) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    cout << flush;
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        CaseResult r = run_case(gc, engine, bench);
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == ssize_t(sizeof(r)) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        return false;
+    }
+    peakRssKb = usage.ru_maxrss;
+    return got == ssize_t(sizeof(result)) && WIFEXITED(status) && WEXITSTATUS(status) == 0 && result.ok;
+}
+
+// Reads a name-based "a b w" edge list (the GRAPH-CODE format), numbering
+// vertices by first appearance. w becomes the cost; times are drawn
+// against it with the given correlation.
+bool load_named_graph(const string &filename, double correlation, uint64_t seed, graph<int, int> &g) {
+    ifstream in(filename);
+    if (!in) {
+        return false;
+    }
+    unordered_map<string, int> ids;
+    vector<array<int, 3>> edges;
+    string a, b;
+    int w;
+    int maxWeight = 1;
+    auto id = [&](const string &name) { return ids.emplace(name, int(ids.size())).first->second; };
+    while (in >> a >> b >> w) {
+        int u = id(a);
+        edges.push_back({u, id(b), w});
+        maxWeight = max(maxWeight, w);
+    }
+    WeightModel weights{maxWeight, correlation};
+    g.loadFrozen(ids.size(), [&](auto &&emit) {
+        for (size_t e = 0; e < edges.size(); ++e) {
+            SplitMix64 rng = itemRng(seed, e);
+            emit(edges[e][0], edges[e][1], edges[e][2], weights.time(edges[e][2], rng));
+        }
+    });
+    return true;
+}
+
+// The cost/time correlation of each generated family
+const vector<pair<string, double>> FAMILIES{{"corr", 0.8}, {"indep", 0.0}, {"anti", -0.8}};
+
+// Case name prefixes, as --topologies and cgen --topology spell them
+const map<Topology, string> TOPOLOGY_NAMES{{Topology::Grid, "grid"}, {Topology::Road, "road"},
+                                           {Topology::Geometric, "geometric"},
+                                           {Topology::PowerLaw, "powerlaw"}};
+
+vector<GraphCase> graph_cases(const BenchConfig &bench) {
+    vector<GraphCase> cases;
+    string input = bench.inputDir + "/input.txt";
+    cases.push_back({"input", [input](graph<int, int> &g) { return loadGraph(input, g); }});
+    string named = bench.inputDir + "/GRAPH-CODE/g1000.g";
+    uint64_t seed = bench.seed;
+    for (const auto &[family, correlation] : FAMILIES) {
+        cases.push_back({"g1000-" + family, [named, correlation, seed](graph<int, int> &g) {
+                             return load_named_graph(named, correlation, seed, g);
+                         }});
+    }
+    for (Topology topology : bench.topologies) {
+        for (int64_t edges : bench.sizes) {
+            for (const auto &[family, correlation] : FAMILIES) {
+                ostringstream name;
+                name << TOPOLOGY_NAMES.at(topology) << "-" << edges << "-" << family;
+                GraphSpec spec;
+                spec.topology = topology;
+                spec.edges = edges;
+                spec.weights.correlation = correlation;
+                spec.seed = seed;
+                auto build = [spec](graph<int, int> &g) {
+                    GraphGenerator generator(spec);
+                    g.loadFrozen(generator.numVertices(), [&](auto &&emit) {
+                        generator.forEachEdge(
+                            [&](int64_t u, int64_t v, int c, int t) { emit(int(u), int(v), c, t); });
+                    });
+                    return true;
+                };
+                cases.push_back({name.str(), build});
+                if (correlation < 0) {
+                    cases.push_back({name.str() + "-cheapest", build, true});
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+string format_result(const string &name, const CaseResult &r, long peakRssKb) {
+    double seconds = r.totalMs / 1000;
+    ostringstream json;
+    json << fixed << setprecision(3);
+    json << "{\"case\":\"" << name << "\",\"vertices\":" << r.vertices << ",\"edges\":" << r.edges
+         << ",\"queries\":" << r.queries << ",\"median_ms\":" << r.medianMs << ",\"p99_ms\":" << r.p99Ms
+         << ",\"queries_per_s\":" << (seconds > 0 ? r.queries / seconds : 0.0) << ",\"labels_per_s\":"
+         << setprecision(0) << (seconds > 0 ? r.labels / seconds : 0.0) << ",\"larac_solved\":" << r.laracSolved
+         << ",\"peak_rss_kb\":" << peakRssKb
+         << ",\"checksum\":\"" << hex << r.checksum << dec << "\"}";
+    return json.str();
+}
+
+// The string or number value of key in one of our JSON lines, as text
+string json_field(const string &line, const string &key) {
+    string quoted = "\"" + key + "\":";
+    size_t at = line.find(quoted);
+    if (at == string::npos) {
+        return "";
+    }
+    at += quoted.size();
+    if (line[at] == '"') {
+        return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+    }
+    return line.substr(at, line.find_first_of(",}", at) - at);
+}
+
+// Compares one case with its baseline line, printing a verdict on stderr.
+// Returns whether it regressed. Differences under 0.05 ms are timer noise
+// on the small graphs and never count.
+bool compare(const string &line, const string &base, double tolerance) {
+    bool regressed = false;
+    ostringstream report;
+    report << fixed << setprecision(3) << json_field(line, "case");
+    for (const char *key : {"median_ms", "p99_ms"}) {
+        double now = stod(json_field(line, key));
+        double before = stod(json_field(base, key));
+        bool slower = now > before * (1 + tolerance) && now - before > 0.05;
+        regressed |= slower;
+        report << "  " << key << " " << before << " -> " << now;
+        if (before > 0) {
+            report << " (" << showpos << 100 * (now / before - 1) << noshowpos << "%)";
+        }
+        report << (slower ? " REGRESSION" : "");
+    }
+    if (json_field(line, "checksum") != json_field(base, "checksum")) {
+        report << "  ANSWERS CHANGED";
+        regressed = true;
+    }
+    cerr << report.str() << endl;
+    return regressed;
+}
+
+bool parse_list(const string &text, function<bool(const string &)> add) {
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ',')) {
+        if (!add(item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void usage() {
+    cout << "usage:  ./cpath_bench [--engines <e1,e2,...>] [--topologies <t1,t2,...>] [--sizes <n1,n2,...>]\n"
+         << "                      [--queries <n>] [--repeats <n>] [--rank <r>] [--slack <s>] [--seed <n>]\n"
+         << "                      [--threads <n>] [--input-dir <dir>] [--out <file>] [--baseline <file>]\n"
+         << "                      [--tolerance <t>]\n"
+         << "Runs each engine (default label,astar,bidir,parallel) on input.txt, GRAPH-CODE/g1000.g\n"
+         << "and seeded graphs of each topology (default grid,road,geometric,powerlaw) and size in\n"
+         << "edges (default 1e4,1e5,1e6,1e7), the generated graphs in correlated, independent and\n"
+         << "anti-correlated cost/time families, the last also with cheapest-within-time queries,\n"
+         << "and prints one JSON line per case (also to --out). Latencies are each query's best of\n"
+         << "--repeats (default 3) runs. --baseline compares each case to a saved run and exits\n"
+         << "with status 1 if its median or p99 latency grew by more than --tolerance (default 0.1)\n"
+         << "or its answers changed.\n";
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig bench;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--engines" && hasValue) {
+                bench.engines.clear();
+                if (!parse_list(argv[++i], [&](const string &name) {
+                        Engine e;
+                        bool known = parse_engine(name, e) && e != Engine::Hierarchy;
+                        bench.engines.push_back(e);
+                        return known;
+                    })) {
+                    cerr << "Error: --engines takes label, astar, bidir and parallel" << endl;
+                    return 1;
+                }
+            } else if (arg == "--topologies" && hasValue) {
+                bench.topologies.clear();
+                if (!parse_list(argv[++i], [&](const string &name) {
+                        Topology t = Topology::Grid;
+                        bool known = parseTopology(name, t);
+                        bench.topologies.push_back(t);
+                        return known;
+                    })) {
+                    cerr << "Error: --topologies takes grid, road, geometric and powerlaw" << endl;
+                    return 1;
+                }
+            } else if (arg == "--sizes" && hasValue) {
+                bench.sizes.clear();
+                parse_list(argv[++i], [&](const string &size) {
+                    bench.sizes.push_back(int64_t(stod(size)));
+                    return true;
+                });
+            } else if (arg == "--queries" && hasValue) {
+                bench.queries = stoi(argv[++i]);
+            } else if (arg == "--repeats" && hasValue) {
+                bench.repeats = max(1, stoi(argv[++i]));
+            } else if (arg == "--rank" && hasValue) {
+                bench.rank = stoi(argv[++i]);
+            } else if (arg == "--slack" && hasValue) {
+                bench.slack = stod(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                bench.seed = stoull(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                bench.threads = max(1, stoi(argv[++i]));
+            } else if (arg == "--input-dir" && hasValue) {
+                bench.inputDir = argv[++i];
+            } else if (arg == "--out" && hasValue) {
+                bench.out = argv[++i];
+            } else if (arg == "--baseline" && hasValue) {
+                bench.baseline = argv[++i];
+            } else if (arg == "--tolerance" && hasValue) {
+                bench.tolerance = stod(argv[++i]);
+            } else {
+                usage();
+                return 1;
+            }
+        } catch (const exception &) {
+            cerr << "Error: bad value for " << arg << endl;
+            return 1;
+        }
+    }
+
+    map<string, string> baseline;
+    if (!bench.baseline.empty()) {
+        ifstream in(bench.baseline);
+        if (!in) {
+            cerr << "Error: Unable to open baseline " << bench.baseline << endl;
+            return 1;
+        }
+        string line;
+        while (getline(in, line)) {
+            baseline[json_field(line, "case")] = line;
+        }
+    }
+    ofstream out;
+    if (!bench.out.empty()) {
+        out.open(bench.out);
+        if (!out) {
+            cerr << "Error: Unable to open output file " << bench.out << endl;
+            return 1;
+        }
+    }
+
+    int regressions = 0;
+    for (const GraphCase &gc : graph_cases(bench)) {
+        for (Engine engine : bench.engines) {
+            string name = gc.name + "/" + engine_name(engine);
+            CaseResult result;
+            long peakRssKb = 0;
+            if (!run_isolated(gc, engine, bench, result, peakRssKb)) {
+                cerr << "Skipped " << name << ": its graph could not be built or the run failed" << endl;
+                continue;
+            }
+            string line = format_result(name, result, peakRssKb);
+            cout << line << endl;
+            if (out) {
+                out << line << endl;
+            }
+            auto base = baseline.find(name);
+            if (base != baseline.end() && compare(line, base->second, bench.tolerance)) {
+                ++regressions;
+            }
+        }
+    }
+    if (!baseline.empty()) {
+        cerr << regressions << " regressed case" << (regressions == 1 ? "" : "s") << " against "
+             << bench.baseline << endl;
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "graph.h"
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Lower bounds used by labelSettingSearch() when it runs without any:
+// every remaining cost and time is 0 and every vertex may reach the
+// destination. All members are constexpr so the plain search pays nothing.
+struct NoBounds {
+    template<typename VertexT>
+    static constexpr bool reachable(const VertexT&) {
+        return true;
+    }
+
+    template<typename VertexT>
+    static constexpr int cost(const VertexT&) {
+        return 0;
+    }
+
+    template<typename VertexT>
+    static constexpr int time(const VertexT&) {
+        return 0;
+    }
+};
+
+// Exact lower bounds on the cost and the time still needed to reach the
+// destination from each vertex, from two single-criterion Dijkstra runs
+// out of the destination (the graph stores both edge directions, so these
+// are the reverse distances).
+//
+// Both runs are confined to the budget: the cost run stops once distances
+// exceed it, and the time run only walks vertices whose cost bound fits.
+// A vertex outside that ball cannot be on any in-budget path, and an
+// in-budget completion never leaves the ball, so the time bound measured
+// inside it is still a valid (and tighter) lower bound.
+//
+// Reusable across queries; compute() only resets the entries the previous
+// query wrote.
+template<typename VertexT, typename WeightT>
+class LowerBounds {
+private:
+    using QueueEntry = pair<WeightT, VertexT>;
+    using MinQueue = priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>>;
+
+    vector<WeightT> costBound;
+    vector<WeightT> timeBound;
+    vector<VertexT> touched;
+
+    // Plain Dijkstra from destination over one criterion; vertices outside
+    // the cost ball are skipped when insideBall is set.
+    template<typename Weight>
+    void dijkstra(const graph<VertexT, WeightT>& g, const VertexT& destination, vector<WeightT>& dist,
+                  const WeightT& limit, bool insideBall, Weight weight) {
+        MinQueue pq;
+        dist[destination] = 0;
+        pq.push({0, destination});
+        while (!pq.empty()) {
+            auto [d, v] = pq.top();
+            pq.pop();
+            if (d > dist[v]) {
+                continue;
+            }
+            for (const auto& edge : g.edges(v)) {
+                if (insideBall && costBound[edge.target] == INFINITE) {
+                    continue;
+                }
+                if (!sumWithin(d, weight(edge), limit)) {
+                    continue;
+                }
+                WeightT nd = d + weight(edge);
+                if (nd < dist[edge.target]) {
+                    if (costBound[edge.target] == INFINITE && timeBound[edge.target] == INFINITE) {
+                        touched.push_back(edge.target);
+                    }
+                    dist[edge.target] = nd;
+                    pq.push({nd, edge.target});
+                }
+            }
+        }
+    }
+
+public:
+    static constexpr WeightT INFINITE = numeric_limits<WeightT>::max();
+
+    LowerBounds(int numVertices = 0) : costBound(numVertices, INFINITE), timeBound(numVertices, INFINITE) {}
+
+    void compute(const graph<VertexT, WeightT>& g, const VertexT& destination, const WeightT& budget) {
+        for (const VertexT& v : touched) {
+            costBound[v] = INFINITE;
+            timeBound[v] = INFINITE;
+        }
+        touched.clear();
+        touched.push_back(destination);
+
+        dijkstra(g, destination, costBound, budget, false, [](const auto& e) { return e.cost; });
+        dijkstra(g, destination, timeBound, INFINITE, true, [](const auto& e) { return e.time; });
+    }
+
+    bool reachable(const VertexT& v) const {
+        return costBound[v] != INFINITE;
+    }
+
+    WeightT cost(const VertexT& v) const {
+        return costBound[v];
+    }
+
+    WeightT time(const VertexT& v) const {
+        return timeBound[v];
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Monotone bucket queue (Dial's algorithm) for label-setting searches with
+// non-negative integer cost keys.
+//
+// Elements are bucketed by pathSignature.cost. Keys are popped in
+// non-decreasing order and every key pushed lies within span - 1 of the
+// last key popped (a key pushed into an empty queue may lie anywhere), so
+// a circular array of span buckets holds each live key in its own bucket.
+// Inside a bucket the elements form a small binary heap ordered by
+// Element::operator< (the same "popped later" order priority_queue uses),
+// which breaks cost ties by time.
+//
+// Push and pop cost O(log bucket size); finding the next bucket is
+// amortized over the keys the search actually reaches.
+//
+// make CHECKS=1 (CPATH_CHECKS) makes push() throw logic_error for a key
+// span or more past the cursor, which would share a bucket with an
+// earlier key and be popped out of order.
+template<typename Element>
+class BucketQueue {
+private:
+    vector<vector<Element>> buckets;
+    size_t span = 0;
+    size_t count = 0;
+    uint64_t cursor = UINT64_MAX; // smallest key that may still be queued
+
+    vector<Element>& current() {
+        while (buckets[cursor % span].empty()) {
+            ++cursor;
+        }
+        return buckets[cursor % span];
+    }
+
+public:
+    // Empties the queue and sizes it for keys that never spread further
+    // than newSpan - 1 apart. Bucket capacity is kept across searches.
+    void reset(size_t newSpan) {
+        if (count > 0) {
+            for (auto& bucket : buckets) {
+                bucket.clear();
+            }
+            count = 0;
+        }
+        if (buckets.size() < newSpan) {
+            buckets.resize(newSpan);
+        }
+        span = newSpan;
+        cursor = UINT64_MAX;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    void push(const Element& e) {
+        // Keys are never below the key last popped, but an emptied queue may
+        // be refilled with keys any distance ahead of it, so the cursor
+        // restarts at the first key pushed into an empty queue.
+        uint64_t key = e.pathSignature.cost;
+        cursor = count == 0 ? key : min(cursor, key);
+#ifdef CPATH_CHECKS
+        if (key - cursor >= span) {
+            throw logic_error("BucketQueue: key pushed past the bucket window");
+        }
+#endif
+        auto& bucket = buckets[key % span];
+        bucket.push_back(e);
+        push_heap(bucket.begin(), bucket.end());
+        ++count;
+    }
+
+    const Element& top() {
+        return current().front();
+    }
+
+    void pop() {
+        auto& bucket = current();
+        pop_heap(bucket.begin(), bucket.end());
+        bucket.pop_back();
+        --count;
+    }
+};
@@ -0,0 +1,154 @@
+#include "graphgen.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Writes a seeded synthetic graph (see graphgen.h) in the text format
+// cpath reads: the vertex count, then one "u v cost time" line per edge.
+//
+// Vertices are formatted in blocks, by all threads at once, into one
+// buffer per block; a round of blocks is then written out in order, so
+// the file is the same for any thread count and memory stays at a round
+// of buffers however large the graph.
+
+// Vertices per formatted block
+const int64_t BLOCK = 1 << 16;
+
+// Formats the edges of vertices first..last-1 into out
+void format_block(const GraphGenerator &generator, int64_t first, int64_t last, string &out) {
+    char line[64];
+    out.clear();
+    for (int64_t u = first; u < last; ++u) {
+        generator.edgesFrom(u, [&](int64_t from, int64_t to, int cost, int time) {
+            char *p = line;
+            p = to_chars(p, line + sizeof(line), from).ptr;
+            *p++ = ' ';
+            p = to_chars(p, line + sizeof(line), to).ptr;
+            *p++ = ' ';
+            p = to_chars(p, line + sizeof(line), cost).ptr;
+            *p++ = ' ';
+            p = to_chars(p, line + sizeof(line), time).ptr;
+            *p++ = '\n';
+            out.append(line, p);
+        });
+    }
+}
+
+// Writes the whole graph to out with numThreads formatting threads;
+// returns the number of edges, or -1 on a write error
+int64_t write_graph(const GraphGenerator &generator, FILE *out, int numThreads) {
+    int64_t n = generator.numVertices();
+    if (fprintf(out, "%lld\n", (long long)n) < 0) {
+        return -1;
+    }
+    int64_t edges = 0;
+    vector<string> buffers(numThreads * 4);
+    for (int64_t roundStart = 0; roundStart < n; roundStart += int64_t(buffers.size()) * BLOCK) {
+        vector<thread> workers;
+        for (int t = 0; t < numThreads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (size_t b = t; b < buffers.size(); b += numThreads) {
+                    int64_t first = min(n, roundStart + int64_t(b) * BLOCK);
+                    format_block(generator, first, min(n, first + BLOCK), buffers[b]);
+                }
+            });
+        }
+        for (thread &w : workers) {
+            w.join();
+        }
+        for (const string &text : buffers) {
+            if (fwrite(text.data(), 1, text.size(), out) != text.size()) {
+                return -1;
+            }
+            edges += count(text.begin(), text.end(), '\n');
+        }
+    }
+    return fflush(out) == 0 ? edges : -1;
+}
+
+void usage() {
+    cout << "usage:  ./cgen [--topology grid|road|geometric|powerlaw] [--edges <m>] [--degree <k>]\n"
+         << "               [--exponent <g>] [--correlation <r>] [--max-weight <w>] [--seed <n>]\n"
+         << "               [--threads <n>] [-o <file>]\n"
+         << "Writes a seeded random graph of about <m> edges (default 1e4) in cpath's\n"
+         << "text format to <file> (default: stdout). Times follow costs with\n"
+         << "correlation <r> in [-1, 1] (default 0; -1 is the hardest); costs are in\n"
+         << "[1, <w>] (default 100). --degree is the average degree of geometric and powerlaw\n"
+         << "graphs (default 8), --exponent the powerlaw degree exponent (default 2.5).\n"
+         << "The same options and seed give the same file on any machine and thread count;\n"
+         << "cpath --write-snapshot turns it into a snapshot that loads without parsing.\n";
+}
+
+int main(int argc, char *argv[]) {
+    GraphSpec spec;
+    string output;
+    int numThreads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--topology" && hasValue) {
+                if (!parseTopology(argv[++i], spec.topology)) {
+                    cerr << "Error: unknown topology " << argv[i] << endl;
+                    return 1;
+                }
+            } else if (arg == "--edges" && hasValue) {
+                spec.edges = int64_t(stod(argv[++i]));
+            } else if (arg == "--degree" && hasValue) {
+                spec.degree = stod(argv[++i]);
+            } else if (arg == "--exponent" && hasValue) {
+                spec.exponent = stod(argv[++i]);
+            } else if (arg == "--correlation" && hasValue) {
+                spec.weights.correlation = clamp(stod(argv[++i]), -1.0, 1.0);
+            } else if (arg == "--max-weight" && hasValue) {
+                spec.weights.maxWeight = stoi(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                spec.seed = stoull(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                numThreads = max(1, stoi(argv[++i]));
+            } else if (arg == "-o" && hasValue) {
+                output = argv[++i];
+            } else {
+                usage();
+                return 1;
+            }
+        } catch (const invalid_argument &) {
+            cerr << "Error: bad value for " << arg << endl;
+            return 1;
+        } catch (const out_of_range &) {
+            cerr << "Error: bad value for " << arg << endl;
+            return 1;
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+    try {
+        GraphGenerator generator(spec);
+        FILE *out = output.empty() ? stdout : fopen(output.c_str(), "wb");
+        if (out == nullptr) {
+            cerr << "Error: Unable to open output file " << output << endl;
+            return 1;
+        }
+        setvbuf(out, nullptr, _IOFBF, 1 << 20);
+        int64_t edges = write_graph(generator, out, numThreads);
+        bool closed = out == stdout || fclose(out) == 0;
+        if (edges < 0 || !closed) {
+            cerr << "Error: Unable to write " << (output.empty() ? "the graph" : output) << endl;
+            return 1;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << "Generated " << generator.numVertices() << " vertices, " << edges << " edges in " << seconds
+             << " s" << endl;
+    } catch (const invalid_argument &e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,107 +1,891 @@
+#include "engine.h"
+#include "frontier_cache.h"
 #include "graph.h"
+#include "graph_io.h"
+#include "hierarchy.h"
+#include "incremental.h"
+#include "pareto.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <queue>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
-// Function to read the graph from a file
-bool readGraphFromFile(const string &filename, graph<int, int> &g) {
-  ifstream inputFile(filename);
-  if (!inputFile.is_open()) {
-    cerr << "Error: Unable to open input file " << filename << endl;
+// A search result in the input graph's terms. Cheapest-path queries run
+// on the graph with cost and time swapped (see load_input()), so their
+// results come back swapped too.
+ConstrainedResult<int> reported(ConstrainedResult<int> result, const SearchConfig &config) {
+    if (config.cheapest) {
+        swap(result.cost, result.time);
+    }
+    return result;
+}
+
+// Prints how large the search's frontiers grew (and, with --epsilon, what
+// the approximation discarded, or what LARAC settled) on stderr
+void print_label_stats(const Workspace &ws, const SearchConfig &config) {
+    FrontierSizes sizes = search_frontier_sizes(ws);
+    cerr << "Labels: " << sizes.labels << " settled at " << sizes.vertices << " vertices, largest frontier "
+         << sizes.largest << ", mean " << (sizes.vertices > 0 ? double(sizes.labels) / sizes.vertices : 0.0);
+    if (config.epsilon > 0) {
+        cerr << "; epsilon " << config.epsilon << " merged " << ws.dominance.merged() << " queued labels";
+    }
+    if (ws.larac.runs > 0) {
+        cerr << "; LARAC " << ws.larac.runs << " runs, ";
+        if (ws.larac.solved) {
+            cerr << "solved";
+        } else {
+            cerr << (config.cheapest ? "cost" : "time") << " bracketed in [" << ws.larac.bracket.lower << ", "
+                 << ws.larac.bracket.upper << "]";
+        }
+    }
+    cerr << endl;
+}
+
+using Clock = chrono::steady_clock;
+
+double ms_since(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Wall time of one query's phases, in milliseconds. load is the graph's,
+// shared by every query of a run.
+struct PhaseTimes {
+    double load = 0;
+    double search = 0;
+    double reconstruct = 0; // reading the answer's path back from the labels
+};
+
+// Writes the --stats-json line of one query on stderr: the query, its
+// answer (result as reported; none for a frontier), where the answer came
+// from, the phase times and, when a search in ws produced it, the
+// |S[v]| distribution and the search counters. Counters exist only in a
+// CPATH_STATS build (see search_stats.h) and cover the label, astar and
+// bidir engines' loops.
+void print_stats_json(const Workspace &ws, const SearchConfig &config, const char *kind, int source,
+                      int destination, int budget, const ConstrainedResult<int> *result, const char *answeredBy,
+                      const PhaseTimes &phases) {
+    ostringstream json;
+    json << fixed << setprecision(3);
+    json << "{\"query\":\"" << kind << "\",\"engine\":\"" << engine_name(config.engine) << "\",\"source\":"
+         << source << ",\"destination\":" << destination << ",\"" << (config.cheapest ? "time_limit" : "budget")
+         << "\":" << budget;
+    if (result != nullptr) {
+        json << ",\"found\":" << (result->found ? "true" : "false");
+        if (result->found) {
+            json << ",\"cost\":" << result->cost << ",\"time\":" << result->time;
+        }
+    }
+    json << ",\"answered_by\":\"" << answeredBy << "\"";
+    if (string(answeredBy) == "search") {
+        FrontierSizes sizes = search_frontier_sizes(ws);
+        json << ",\"frontier\":{\"vertices\":" << sizes.vertices << ",\"labels\":" << sizes.labels
+             << ",\"max\":" << sizes.largest << ",\"mean\":"
+             << (sizes.vertices > 0 ? double(sizes.labels) / sizes.vertices : 0.0) << ",\"p99\":" << sizes.p99
+             << "}";
+#ifdef CPATH_STATS
+        if (config.engine == Engine::LabelSetting || config.engine == Engine::LowerBounded ||
+            config.engine == Engine::Bidirectional) {
+            SearchCounters counters = ws.forward.counters;
+            counters += ws.backward.counters;
+            json << ",\"counters\":{\"generated\":" << counters.generated << ",\"pruned_by_dominance\":"
+                 << counters.prunedByDominance << ",\"pruned_by_budget\":" << counters.prunedByBudget
+                 << ",\"pushes\":" << counters.pushes << ",\"pops\":" << counters.pops
+                 << ",\"peak_queue\":" << counters.peakQueue << "}";
+        }
+#endif
+    }
+    json << ",\"phases_ms\":{\"load\":" << phases.load << ",\"search\":" << phases.search
+         << ",\"reconstruct\":" << phases.reconstruct << "}}";
+    cerr << json.str() << endl;
+}
+
+// The guarantee an epsilon search gives, as printed after its answer
+void print_approximation(ostream &out, double bound, const SearchConfig &config) {
+    out << "Approximation: epsilon " << config.epsilon << ", time within a factor of " << bound
+        << " of exact" << endl;
+}
+
+// Writes a path as "v0 -> v1 -> ... -> vk"
+void print_path(ostream &out, const vector<int> &path) {
+    for (size_t i = 0; i < path.size(); ++i) {
+        out << (i > 0 ? " -> " : "") << path[i];
+    }
+}
+
+// Function to find the fastest path whose total cost stays within the budget
+// (with --cheapest, the cheapest path whose time stays within the limit)
+void closest_constrained_path(const graph<int, int> &g, int source, int destination, int budget,
+                              const SearchConfig &config) {
+    Workspace ws(g, config);
+    PhaseTimes phases;
+    phases.load = config.loadMs;
+    Clock::time_point start = Clock::now();
+    ConstrainedResult<int> result =
+        reported(constrained_query(g, ws, config, source, destination, budget), config);
+    phases.search = ms_since(start);
+
+    if (config.labelStats) {
+        print_label_stats(ws, config);
+    }
+
+    if (result.found) {
+        start = Clock::now();
+        vector<int> path = config.engine == Engine::Hierarchy
+                               ? hierarchyPath(*config.hierarchy, ws.forward, ws.backward, result)
+                               : resultPath(ws.forward, ws.backward, result);
+        phases.reconstruct = ms_since(start);
+        cout << "Cost: " << result.cost << ", Time: " << result.time << endl;
+        cout << "Path: ";
+        print_path(cout, path);
+        cout << endl;
+        if (config.epsilon > 0) {
+            print_approximation(cout, result.approximation, config);
+        }
+    } else {
+        // If no feasible path exists within the budget and time constraint
+        cout << "No feasible path within the budget and time constraint." << endl;
+    }
+    if (config.statsJson) {
+        print_stats_json(ws, config, "single", source, destination, budget, &result,
+                         ws.larac.solved ? "larac" : "search", phases);
+    }
+}
+
+
+// One line of a batch query file: "s d budget" (a time limit with --cheapest)
+struct Query {
+  int source;
+  int destination;
+  int budget;
+};
+
+// Frontiers cached across queries, labels stripped (they point into a
+// search workspace that is reused)
+using FrontierStore = FrontierCache<int, graph<int, int>::NonDominatedPathsSet>;
+
+const size_t DEFAULT_CACHE_BYTES = size_t(64) << 20;
+
+// Parses one "s d budget" line. Returns false on a blank line or, with a
+// message naming lineNo, on one that does not parse (setting bad).
+bool parse_query(const string &line, int lineNo, Query &q, bool &bad) {
+  bad = false;
+  if (line.find_first_not_of(" \t\r") == string::npos) {
     return false;
   }
+  istringstream fields(line);
+  if (!(fields >> q.source >> q.destination >> q.budget)) {
+    cerr << "Error: bad query on line " << lineNo << ": " << line << endl;
+    bad = true;
+    return false;
+  }
+  return true;
+}
 
-  int numVertices;
-  inputFile >> numVertices;
-
-  int u, v, c, t;
-  while (inputFile >> u >> v >> c >> t) {
-    g.addEdge(u, v, c, t);
+// Reads "s d budget" lines. Blank lines are skipped; anything else that
+// does not parse is reported with its line number.
+bool read_queries(istream &in, vector<Query> &queries) {
+  string line;
+  int lineNo = 0;
+  while (getline(in, line)) {
+    Query q;
+    bool bad;
+    if (parse_query(line, ++lineNo, q, bad)) {
+      queries.push_back(q);
+    } else if (bad) {
+      return false;
+    }
   }
+  return true;
+}
 
-  inputFile.close();
-  
+// A serve mode line "update u v cost time": new weights for the edge u-v
+struct EdgeUpdate {
+  int from;
+  int to;
+  int cost;
+  int time;
+};
+
+// Parses an update line (one whose first word is "update"). Returns false
+// when the line is not one; sets bad, with a message naming lineNo, when
+// it is but does not parse.
+bool parse_update(const string &line, int lineNo, EdgeUpdate &u, bool &bad) {
+  bad = false;
+  istringstream fields(line);
+  string word;
+  if (!(fields >> word) || word != "update") {
+    return false;
+  }
+  if (!(fields >> u.from >> u.to >> u.cost >> u.time) || !graph<int, int>::validWeight(u.cost) ||
+      !graph<int, int>::validWeight(u.time)) {
+    cerr << "Error: bad update on line " << lineNo << ": " << line << endl;
+    bad = true;
+  }
   return true;
 }
 
-// Function to perform the Dijkstra-like algorithm considering both cost and time constraints
-void closest_constrained_path(const graph<int, int> &g, int source, int destination, int budget) {
-    vector<int> minCost(
-        g.NumVertices(),
-        numeric_limits<int>::max()); // Minimum cost to reach each vertex
-    vector<int> minTime(
-        g.NumVertices(),
-        numeric_limits<int>::max());       // Minimum time to reach each vertex
-    vector<int> prev(g.NumVertices(), -1); // Previous vertex in the shortest path
-
-    priority_queue<pair<pair<int, int>, int>, vector<pair<pair<int, int>, int>>,
-                   greater<pair<pair<int, int>, int>>>
-        pq;
-    pq.push({{0, 0}, source}); // Initial path with cost = 0 and time = 0 at the source vertex
-    minCost[source] = 0;  // Cost at source vertex
-    minTime[source] = 0;  // Time at source vertex
-
-    while (!pq.empty()) {
-        auto [curWeight, currentVertex] = pq.top();
-        auto [currentCost, currentTime] = curWeight;
-        pq.pop();
-
-        // Skip paths that exceed the budget or time constraint
-        if (currentCost > budget) {
-            continue;
+// One output line of batch and serve modes
+string format_answer(const Query &q, bool valid, const ConstrainedResult<int> &searched,
+                     const SearchConfig &config) {
+  ConstrainedResult<int> result = reported(searched, config);
+  string out = to_string(q.source) + ' ' + to_string(q.destination) + ' ' + to_string(q.budget);
+  if (!valid) {
+    out += " invalid\n";
+  } else if (result.found) {
+    out += ' ' + to_string(result.cost) + ' ' + to_string(result.time) + '\n';
+  } else {
+    out += " none\n";
+  }
+  return out;
+}
+
+void print_cache_stats(const FrontierStore &cache) {
+  auto stats = cache.statistics();
+  cerr << "Frontier cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+       << stats.evictions << " evictions, " << stats.frontiers << " frontiers (" << stats.frontierBytes
+       << " bytes), " << stats.pending << " pairs counting misses (" << stats.pendingBytes << " bytes)"
+       << endl;
+}
+
+graph<int, int>::NonDominatedPathsSet without_labels(graph<int, int>::NonDominatedPathsSet frontier) {
+  for (auto &ps : frontier) {
+    ps.label = NO_LABEL;
+  }
+  return frontier;
+}
+
+// Answers every query against one loaded graph. Queries sharing an
+// (s, d) pair are grouped: a lone query runs the pruned search, while a
+// group computes the destination frontier once (capped at the group's
+// largest budget), answers each budget from it by binary search and
+// leaves it in the cache. A group whose largest budget a cached frontier
+// covers is answered from the cache instead. Workers pull groups from a
+// shared counter and each keeps its own search workspace; results are
+// written by query index so the output follows the input order.
+//
+// Output is one line per query: "s d budget cost time", or
+// "s d budget none" when nothing fits the budget.
+void run_batch(const graph<int, int> &g, const vector<Query> &queries, int numThreads,
+               const SearchConfig &config, FrontierStore &cache) {
+  vector<ConstrainedResult<int>> results(queries.size());
+  vector<char> valid(queries.size(), 1);
+
+  map<pair<int, int>, vector<size_t>> byPair;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    byPair[{queries[i].source, queries[i].destination}].push_back(i);
+  }
+  vector<const vector<size_t> *> groups;
+  for (const auto &entry : byPair) {
+    groups.push_back(&entry.second);
+  }
+  atomic<size_t> next(0);
+
+  auto worker = [&]() {
+    Workspace ws(g, config);
+    for (size_t i = next++; i < groups.size(); i = next++) {
+      const vector<size_t> &group = *groups[i];
+      const Query &q = queries[group[0]];
+      if (q.source < 0 || q.source >= g.NumVertices() || q.destination < 0 ||
+          q.destination >= g.NumVertices()) {
+        for (size_t k : group) {
+          valid[k] = 0;
+        }
+        continue;
+      }
+      int maxBudget = queries[group[0]].budget;
+      for (size_t k : group) {
+        maxBudget = max(maxBudget, queries[k].budget);
+      }
+      auto answerAll = [&](const graph<int, int>::NonDominatedPathsSet &frontier) {
+        for (size_t k : group) {
+          results[k] = fastestWithinBudget(frontier, queries[k].budget);
+        }
+      };
+      if (cache.enabled() && cache.lookup(q.source, q.destination, maxBudget, answerAll)) {
+        continue;
+      }
+      if (group.size() == 1) {
+        results[group[0]] = constrained_query(g, ws, config, q.source, q.destination, q.budget);
+        continue;
+      }
+      auto frontier = constrained_frontier(g, ws, config, q.source, q.destination, maxBudget);
+      answerAll(frontier);
+      cache.insert(q.source, q.destination, maxBudget, without_labels(move(frontier)));
+    }
+  };
+
+  numThreads = max(1, min<int>(numThreads, groups.size()));
+  vector<thread> workers;
+  for (int t = 1; t < numThreads; ++t) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  string out;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    out += format_answer(queries[i], valid[i], results[i], config);
+  }
+  cout << out;
+}
+
+// Misses a serve pair takes, answered by pruned searches, before it gets
+// a cached frontier. On large graphs a frontier capped near the budget
+// costs tens of pruned searches, so only pairs that keep coming back earn
+// one.
+const uint32_t FRONTIER_ADMIT_MISSES = 8;
+
+// Answers "s d budget" lines from stdin as they arrive, one flushed line
+// each in the batch output format. Queries go through the frontier cache:
+// a pair with a cached frontier is answered by binary search for any
+// budget up to its cap. Misses run the pruned search until the pair has
+// missed FRONTIER_ADMIT_MISSES times, and then compute its frontier capped
+// at the largest budget those misses asked for, so a pair's cap follows
+// its own budgets. With the cache disabled each query runs the pruned
+// search.
+//
+// "update u v cost time" lines change an edge's weights in place (see
+// graph::updateEdge()) and are echoed with " ok", or " invalid" for an
+// unknown edge or under the ch engine, whose hierarchy they would break.
+// An update empties the frontier cache. With incremental set, queries are
+// answered instead from the frontiers of every vertex from the query's
+// source (see incremental.h), which updates repair rather than discard:
+// built when the source or a larger budget comes along, repaired before
+// the next query after updates.
+void serve(graph<int, int> &g, SearchConfig config, FrontierStore &cache, bool incremental) {
+  Workspace ws(g, config);
+  IncrementalFrontier<int, int> frontiers(incremental ? g.NumVertices() : 0);
+  vector<pair<int, int>> changed; // edges updated since the frontiers were last repaired
+  string line;
+  int lineNo = 0;
+  while (getline(cin, line)) {
+    EdgeUpdate update;
+    bool bad;
+    if (parse_update(line, ++lineNo, update, bad)) {
+      if (bad) {
+        continue;
+      }
+      // The searched graph has the criteria swapped under --cheapest
+      int cost = config.cheapest ? update.time : update.cost;
+      int time = config.cheapest ? update.cost : update.time;
+      bool ok = config.engine != Engine::Hierarchy && g.updateEdge(update.from, update.to, cost, time);
+      if (ok) {
+        cache.clear();
+        if (incremental) {
+          changed.push_back({update.from, update.to});
         }
+        // Bounds that stay valid, if looser, until the next full scan
+        config.maxEdgeCost = max(config.maxEdgeCost, cost);
+        if (cost > 0) {
+          config.window.minPositiveCost = min(config.window.minPositiveCost, cost);
+        } else {
+          config.window.zeroCostEdges = true;
+        }
+      }
+      cout << "update " << update.from << ' ' << update.to << ' ' << update.cost << ' ' << update.time
+           << (ok ? " ok" : " invalid") << endl;
+      continue;
+    }
+    Query q;
+    if (!parse_query(line, lineNo, q, bad)) {
+      continue;
+    }
+    ConstrainedResult<int> result;
+    bool valid = q.source >= 0 && q.source < g.NumVertices() && q.destination >= 0 &&
+                 q.destination < g.NumVertices();
+    FrontierStore::Miss miss;
+    auto answer = [&](const graph<int, int>::NonDominatedPathsSet &frontier) {
+      result = fastestWithinBudget(frontier, q.budget);
+    };
+    const char *answeredBy = "search";
+    Clock::time_point start = Clock::now();
+    if (!valid) {
+      // rejected without a search
+    } else if (incremental) {
+      answeredBy = "incremental";
+      if (frontiers.covers(q.source, q.budget)) {
+        frontiers.repair(g, changed);
+        if (config.labelStats && !changed.empty()) {
+          const auto &stats = frontiers.lastRepair();
+          cerr << "Repair: " << changed.size() << " edges, " << stats.removed << " labels removed, "
+               << stats.added << " added" << (stats.rebuilt ? " (rebuilt)" : "") << endl;
+        }
+      } else {
+        frontiers.build(g, q.source, q.budget);
+      }
+      changed.clear();
+      result = frontiers.query(q.destination, q.budget);
+    } else if (cache.enabled() && cache.lookup(q.source, q.destination, q.budget, answer, &miss)) {
+      answeredBy = "cache";
+    } else if (!cache.enabled() || miss.count < FRONTIER_ADMIT_MISSES) {
+      result = constrained_query(g, ws, config, q.source, q.destination, q.budget);
+      if (ws.larac.solved) {
+        answeredBy = "larac";
+      }
+    } else {
+      answeredBy = "frontier";
+      auto frontier = constrained_frontier(g, ws, config, q.source, q.destination, miss.largestBudget);
+      answer(frontier);
+      cache.insert(q.source, q.destination, miss.largestBudget, without_labels(move(frontier)));
+    }
+    PhaseTimes phases;
+    phases.load = config.loadMs;
+    phases.search = ms_since(start);
+    cout << format_answer(q, valid, result, config) << flush;
+    if (config.statsJson && valid) {
+      ConstrainedResult<int> answered = reported(result, config);
+      print_stats_json(ws, config, "single", q.source, q.destination, q.budget, &answered, answeredBy, phases);
+    }
+  }
+}
 
-        if (currentVertex == destination) {
-            // Found the destination vertex
-            cout << "Cost: " << minCost[destination]
-                << ", Time: " << minTime[destination] << endl;
-            return;
+// Prints the destination's whole non-dominated frontier, cost ascending
+void print_frontier(const graph<int, int> &g, int source, int destination, int maxBudget,
+                    const SearchConfig &config) {
+    Workspace ws(g, config);
+    PhaseTimes phases;
+    phases.load = config.loadMs;
+    Clock::time_point start = Clock::now();
+    if (config.engine == Engine::Hierarchy) {
+        auto frontier = hierarchyFrontier(*config.hierarchy, ws.forward, ws.backward, source, destination,
+                                          maxBudget);
+        phases.search = ms_since(start);
+        cout << "Pareto frontier: " << frontier.size() << " non-dominated paths" << endl;
+        for (const auto &r : frontier) {
+            start = Clock::now();
+            vector<int> path = hierarchyPath(*config.hierarchy, ws.forward, ws.backward, r);
+            phases.reconstruct += ms_since(start);
+            cout << "Cost: " << r.cost << ", Time: " << r.time << ", Path: ";
+            print_path(cout, path);
+            cout << endl;
+        }
+    } else {
+        auto frontier = constrained_frontier(g, ws, config, source, destination, maxBudget);
+        phases.search = ms_since(start);
+        if (config.labelStats) {
+            print_label_stats(ws, config);
         }
 
-        for (int neighbor : g.neighbors(currentVertex)) {
-            int edgeCost, edgeTime;
-            if (g.getWeight(currentVertex, neighbor, edgeCost, edgeTime)) {
-                int newCost = currentCost + edgeCost;
-                int newTime = currentTime + edgeTime;
-
-                // Relaxation step
-                if (newCost <= budget && newCost < minCost[neighbor]) {
-                    minCost[neighbor] = newCost;
-                    minTime[neighbor] = newTime;
-                    prev[neighbor] = currentVertex;
-                    pq.push({{newCost, newTime}, neighbor});
-                }
-            }
+        cout << "Pareto frontier: " << frontier.size() << " non-dominated paths" << endl;
+        if (config.epsilon > 0) {
+            print_approximation(cout, 1 + config.epsilon, config);
+        }
+        for (const auto &ps : frontier) {
+            start = Clock::now();
+            vector<int> path = ws.forward.pathTo(ps.label);
+            phases.reconstruct += ms_since(start);
+            cout << "Cost: " << ps.cost << ", Time: " << ps.time << ", Path: ";
+            print_path(cout, path);
+            cout << endl;
         }
     }
+    if (config.statsJson) {
+        print_stats_json(ws, config, "frontier", source, destination, maxBudget, nullptr, "search", phases);
+    }
+}
 
-    // If no feasible path exists within the budget and time constraint
-    cout << "No feasible path within the budget and time constraint." << endl;
+// Streams the frontier of every vertex reachable from source within
+// maxBudget as "v cost time" lines, one per frontier entry, cost
+// ascending. A vertex's lines are written together as soon as its frontier
+// is final (see paretoOneToAll()), so output starts long before the sweep
+// ends. Every engine but ch runs the same plain label-setting sweep.
+void print_all_frontiers(const graph<int, int> &g, int source, int maxBudget, const SearchConfig &config) {
+  graph<int, int>::GraphAlgorithmState state(g.NumVertices());
+  LowerBounds<int, int> fastest(g.NumVertices());
+  fastest.compute(g, source, maxBudget);
+  string lines;
+  auto emit = [&](int v, const graph<int, int>::NonDominatedPathsSet &frontier) {
+    lines.clear();
+    for (const auto &ps : frontier) {
+      lines += to_string(v) + " " + to_string(ps.cost) + " " + to_string(ps.time) + "\n";
+    }
+    cout << lines;
+  };
+  paretoOneToAll(g, state, source, maxBudget, fastest, emit,
+                 labelBucketSpan(config.queue, config.maxEdgeCost, maxBudget, false));
+  cout << flush;
 }
 
+void usage() {
+  cout << "usage:  ./cpath [--engine <name>] [--queue <kind>] [--threads <n>] [--epsilon <e>] [--no-larac] [--label-stats] [--stats-json] <file> <source_vertex> <destination_vertex> <budget>\n"
+       << "        ./cpath [--engine <name>] [--queue <kind>] [--threads <n>] [--no-larac] [--label-stats] [--stats-json] --cheapest <file> <source_vertex> <destination_vertex> <time_limit>\n"
+       << "        ./cpath [--engine <name>] [--threads <n>] [--epsilon <e>] [--label-stats] [--stats-json] --frontier <file> <source_vertex> <destination_vertex> [<max_budget>]\n"
+       << "        ./cpath [--queue <kind>] --all <file> <source_vertex> [<max_budget>]\n"
+       << "        ./cpath [--engine <name>] [--queue <kind>] [--threads <n>] [--no-larac] [--cheapest] [--cache-bytes <n>] --batch <file> [<query_file>]\n"
+       << "        ./cpath [--engine <name>] [--queue <kind>] [--threads <n>] [--no-larac] [--cheapest] [--cache-bytes <n>] [--incremental] [--stats-json] --serve <file>\n"
+       << "        ./cpath --write-snapshot <graph_file> <snapshot_file>\n"
+       << "        ./cpath --verify-snapshot <snapshot_file>\n"
+       << "        ./cpath --write-hierarchy <graph_file> <hierarchy_file>\n"
+       << "<file> may be a text edge list or a snapshot written by --write-snapshot;\n"
+       << "with --engine ch it is a hierarchy written by --write-hierarchy.\n"
+       << "--engine picks the search; all give the same answers:\n"
+       << "  astar   label setting pruned by reverse-Dijkstra lower bounds (default)\n"
+       << "  label   plain label setting\n"
+       << "  bidir   label setting from both ends at once\n"
+       << "  parallel  label setting that expands each round of final labels\n"
+       << "            on --threads workers (one query at a time)\n"
+       << "  ch      upward searches in a precomputed contraction hierarchy\n"
+       << "--queue heap|buckets|auto picks the label queue of label/astar/parallel searches;\n"
+       << "  auto (default) uses integer cost buckets unless edge costs are large.\n"
+       << "--kernel auto|scalar|sse2|avx2 picks the edge relaxation filter; auto\n"
+       << "  (default) uses the widest one the CPU supports.\n"
+       << "--epsilon e (label and astar engines) also drops labels another label beats\n"
+       << "  within a factor 1 + e on both cost and time, and prints the factor the\n"
+       << "  answer's time is guaranteed to be within; --label-stats prints frontier sizes.\n"
+       << "Exact astar queries first try a few Lagrangian (LARAC) shortest path runs,\n"
+       << "  which often settle the query and otherwise bound the label search;\n"
+       << "  --no-larac skips them.\n"
+       << "--stats-json writes one JSON line per query on stderr: the answer, what\n"
+       << "  answered it, frontier sizes (mean, max, p99) and load/search/reconstruct\n"
+       << "  times; a build with make STATS=1 adds label and queue counters.\n"
+       << "--cheapest asks the dual question: the cheapest path whose time fits the\n"
+       << "  limit (ties to the faster one). Searches run in time order, pruned by the\n"
+       << "  limit; with --batch and --serve the third column is the time limit.\n"
+       << "--all streams \"v cost time\" lines for the frontier of every vertex reachable\n"
+       << "  from the source, each vertex's lines as soon as its frontier is final.\n"
+       << "--batch reads \"s d budget\" lines from <query_file> (default: stdin) and\n"
+       << "prints \"s d budget cost time\" (or \"none\") per query, in input order.\n"
+       << "--serve answers \"s d budget\" lines from stdin one at a time, as they arrive;\n"
+       << "  \"update u v cost time\" lines change an edge's weights in place. With\n"
+       << "  --incremental, queries read the frontiers of every vertex from their source,\n"
+       << "  which updates repair locally instead of starting over.\n"
+       << "--cache-bytes caps the (s, d) frontier cache of --batch and --serve (suffix\n"
+       << "  K/M/G; default 64M, 0 disables); --cache-stats prints its counters on stderr.\n";
+}
+
+// Converts a graph (text or snapshot) into a binary snapshot
+int write_snapshot(const string &input, const string &output) {
+  graph<int, int> g;
+  if (!loadGraph(input, g) || !writeSnapshot(output, g)) {
+    return 1;
+  }
+  cout << "Wrote " << output << ": " << g.NumVertices() << " vertices, "
+       << g.NumEdges() << " directed edges" << endl;
+  return 0;
+}
+
+// Contracts a graph (text or snapshot) and writes the hierarchy
+int write_hierarchy(const string &input, const string &output) {
+  graph<int, int> g;
+  if (!loadGraph(input, g)) {
+    return 1;
+  }
+  ContractionHierarchy<int, int> hierarchy = buildHierarchy(g);
+  if (!writeHierarchy(output, hierarchy)) {
+    return 1;
+  }
+  cout << "Wrote " << output << ": " << hierarchy.NumVertices() << " vertices, "
+       << hierarchy.coreSize() << " in the core, " << hierarchy.upwardGraph().NumEdges()
+       << " upward edges (" << hierarchy.numShortcuts() << " shortcuts)" << endl;
+  return 0;
+}
+
+// Loads <file> for the configured engine. The ch engine reads a hierarchy
+// and searches its upward graph, which then stands in for g. --cheapest
+// swaps the graph's criteria, so the engines answer it unchanged.
+bool load_input(const string &filename, graph<int, int> &g, ContractionHierarchy<int, int> &hierarchy,
+                SearchConfig &config) {
+  if (config.engine == Engine::Hierarchy) {
+    if (!loadHierarchy(filename, hierarchy)) {
+      return false;
+    }
+    g = hierarchy.upwardGraph();
+    config.hierarchy = &hierarchy;
+    return true;
+  }
+  if (!loadGraph(filename, g)) {
+    return false;
+  }
+  if (config.cheapest) {
+    g = g.swappedCriteria();
+  }
+  return true;
+}
+
+// Checks every checksum in a snapshot, not just the header's
+int verify_snapshot(const string &filename) {
+  graph<int, int> g;
+  if (!loadSnapshot(filename, g, true)) {
+    return 1;
+  }
+  cout << filename << ": OK" << endl;
+  return 0;
+}
+
+// Where --batch and --serve keep frontiers between queries
+struct CacheConfig {
+  size_t bytes = DEFAULT_CACHE_BYTES;
+  bool reportStats = false; // print the counters on stderr when done
+};
+
+// Parses a byte count with an optional K, M or G suffix (powers of 1024)
+bool parse_bytes(const string &text, size_t &bytes) {
+  size_t end = 0;
+  unsigned long long value;
+  try {
+    value = stoull(text, &end);
+  } catch (const exception &) {
+    return false;
+  }
+  string suffix = text.substr(end);
+  int shift = 0;
+  if (suffix == "K" || suffix == "k") {
+    shift = 10;
+  } else if (suffix == "M" || suffix == "m") {
+    shift = 20;
+  } else if (suffix == "G" || suffix == "g") {
+    shift = 30;
+  } else if (!suffix.empty()) {
+    return false;
+  }
+  bytes = size_t(value) << shift;
+  return true;
+}
+
+int batch(const string &filename, const string &queryFile, int numThreads, SearchConfig config,
+          const CacheConfig &cacheConfig) {
+  graph<int, int> g;
+  ContractionHierarchy<int, int> hierarchy;
+  if (!load_input(filename, g, hierarchy, config)) {
+    return 1;
+  }
+  config.maxEdgeCost = g.maxEdgeCost();
+  config.window = labelWindow(g);
+  // Threads already go to separate queries
+  config.searchThreads = 1;
+
+  vector<Query> queries;
+  if (queryFile.empty()) {
+    if (!read_queries(cin, queries)) {
+      return 1;
+    }
+  } else {
+    ifstream in(queryFile);
+    if (!in.is_open()) {
+      cerr << "Error: Unable to open query file " << queryFile << endl;
+      return 1;
+    }
+    if (!read_queries(in, queries)) {
+      return 1;
+    }
+  }
+
+  FrontierStore cache(cacheConfig.bytes);
+  run_batch(g, queries, numThreads, config, cache);
+  if (cacheConfig.reportStats) {
+    print_cache_stats(cache);
+  }
+  return 0;
+}
+
+int serve_mode(const string &filename, int numThreads, SearchConfig config, const CacheConfig &cacheConfig,
+               bool incremental) {
+  graph<int, int> g;
+  ContractionHierarchy<int, int> hierarchy;
+  Clock::time_point start = Clock::now();
+  if (!load_input(filename, g, hierarchy, config)) {
+    return 1;
+  }
+  config.loadMs = ms_since(start);
+  config.maxEdgeCost = g.maxEdgeCost();
+  config.window = labelWindow(g);
+  config.searchThreads = numThreads;
+
+  FrontierStore cache(cacheConfig.bytes);
+  serve(g, config, cache, incremental);
+  if (cacheConfig.reportStats) {
+    print_cache_stats(cache);
+  }
+  return 0;
+}
 
 int main(int argc, char *argv[]) {
+  // Pull out option flags; what is left are the mode's positional arguments
+  vector<string> args;
+  bool batchMode = false;
+  bool serveMode = false;
+  bool frontierMode = false;
+  bool allMode = false;
+  bool incrementalMode = false;
+  SearchConfig config;
+  CacheConfig cacheConfig;
+  int numThreads = max(1u, thread::hardware_concurrency());
+  bool engineGiven = false;
+  bool threadsGiven = false;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "--batch") {
+      batchMode = true;
+    } else if (arg == "--serve") {
+      serveMode = true;
+    } else if (arg == "--cache-bytes" && i + 1 < argc) {
+      if (!parse_bytes(argv[++i], cacheConfig.bytes)) {
+        cerr << "Error: bad byte count " << argv[i] << endl;
+        return 1;
+      }
+    } else if (arg == "--cache-stats") {
+      cacheConfig.reportStats = true;
+    } else if (arg == "--frontier") {
+      frontierMode = true;
+    } else if (arg == "--all") {
+      allMode = true;
+    } else if (arg == "--incremental") {
+      incrementalMode = true;
+    } else if (arg == "--engine" && i + 1 < argc) {
+      string name = argv[++i];
+      if (!parse_engine(name, config.engine)) {
+        cerr << "Error: unknown engine " << name << endl;
+        return 1;
+      }
+      engineGiven = true;
+    } else if (arg == "--queue" && i + 1 < argc) {
+      string name = argv[++i];
+      if (name == "heap") {
+        config.queue = LabelQueue::Heap;
+      } else if (name == "buckets") {
+        config.queue = LabelQueue::Buckets;
+      } else if (name == "auto") {
+        config.queue = LabelQueue::Auto;
+      } else {
+        cerr << "Error: unknown queue " << name << endl;
+        return 1;
+      }
+    } else if (arg == "--epsilon" && i + 1 < argc) {
+      config.epsilon = stod(argv[++i]);
+      if (!(config.epsilon >= 0)) {
+        cerr << "Error: epsilon must be non-negative" << endl;
+        return 1;
+      }
+    } else if (arg == "--label-stats") {
+      config.labelStats = true;
+    } else if (arg == "--stats-json") {
+      config.statsJson = true;
+    } else if (arg == "--cheapest") {
+      config.cheapest = true;
+    } else if (arg == "--no-larac") {
+      config.larac = false;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      numThreads = stoi(argv[++i]);
+      threadsGiven = true;
+    } else if (arg == "--kernel" && i + 1 < argc) {
+      string name = argv[++i];
+      RelaxKernel kind;
+      if (name == "auto") {
+        kind = RelaxKernel::Auto;
+      } else if (name == "scalar") {
+        kind = RelaxKernel::Scalar;
+      } else if (name == "sse2") {
+        kind = RelaxKernel::SSE2;
+      } else if (name == "avx2") {
+        kind = RelaxKernel::AVX2;
+      } else {
+        cerr << "Error: unknown kernel " << name << endl;
+        return 1;
+      }
+      if (!selectRelaxKernel(kind)) {
+        cerr << "Error: kernel " << name << " is not supported on this machine" << endl;
+        return 1;
+      }
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  if (config.epsilon > 0 && (batchMode || serveMode || allMode ||
+                             (config.engine != Engine::LabelSetting && config.engine != Engine::LowerBounded))) {
+    cerr << "Error: --epsilon needs the label or astar engine and one query or --frontier" << endl;
+    return 1;
+  }
+  if (config.cheapest && (frontierMode || allMode || config.epsilon > 0 || config.engine == Engine::Hierarchy)) {
+    cerr << "Error: --cheapest answers single, --batch and --serve queries, exactly and without ch" << endl;
+    return 1;
+  }
+  if (allMode && (engineGiven || threadsGiven)) {
+    cerr << "Error: --all runs its own sweep over the graph itself; it takes no --engine or --threads" << endl;
+    return 1;
+  }
+  if (config.statsJson && (batchMode || allMode)) {
+    cerr << "Error: --stats-json reports single, --frontier and --serve queries" << endl;
+    return 1;
+  }
+  if (incrementalMode && (!serveMode || config.engine == Engine::Hierarchy)) {
+    cerr << "Error: --incremental needs --serve on the graph itself, not a hierarchy" << endl;
+    return 1;
+  }
+  if (args.size() == 3 && args[0] == "--write-snapshot") {
+    return write_snapshot(args[1], args[2]);
+  }
+  if (args.size() == 2 && args[0] == "--verify-snapshot") {
+    return verify_snapshot(args[1]);
+  }
+  if (args.size() == 3 && args[0] == "--write-hierarchy") {
+    return write_hierarchy(args[1], args[2]);
+  }
+  if (batchMode && (args.size() == 1 || args.size() == 2)) {
+    return batch(args[0], args.size() == 2 ? args[1] : "", numThreads, config, cacheConfig);
+  }
+  if (serveMode && args.size() == 1) {
+    return serve_mode(args[0], numThreads, config, cacheConfig, incrementalMode);
+  }
+  // A frontier needs no budget; when given it caps the search
+  bool budgetGiven = args.size() == (allMode ? 3 : 4);
+  bool enoughArgs = budgetGiven || (allMode && args.size() == 2) || (frontierMode && args.size() == 3);
+  if (batchMode || serveMode || !enoughArgs || (allMode && frontierMode)) {
+    usage();
+    return 1;
+  }
+
   // Parse command line arguments
-  string filename = argv[1];
-  int source = stoi(argv[2]);
-  int destination = stoi(argv[3]);
-  int budget = stoi(argv[4]);
+  string filename = args[0];
+  int source = stoi(args[1]);
+  int destination = allMode ? source : stoi(args[2]);
+  int budget = budgetGiven ? stoi(args.back()) : numeric_limits<int>::max();
 
   // Create a graph instance
   graph<int, int> g;
+  ContractionHierarchy<int, int> hierarchy;
+
+  // Read the graph from input file (text or snapshot, or a hierarchy)
+  Clock::time_point start = Clock::now();
+  if (!load_input(filename, g, hierarchy, config)) {
+    return 1;
+  }
+  config.loadMs = ms_since(start);
+
+  config.maxEdgeCost = g.maxEdgeCost();
+  config.window = labelWindow(g);
+  config.searchThreads = numThreads;
 
-  // Read the graph from input file
-  if (!readGraphFromFile(filename, g)) {
+  if (source < 0 || source >= g.NumVertices() || destination < 0 ||
+      destination >= g.NumVertices()) {
+    cerr << "Error: vertices must be in the range 0.." << g.NumVertices() - 1 << endl;
     return 1;
   }
 
+  if (allMode) {
+    print_all_frontiers(g, source, budget, config);
+    return 0;
+  }
+  if (frontierMode) {
+    print_frontier(g, source, destination, budget, config);
+    return 0;
+  }
+
   // Perform Dijkstra-like algorithm to find the fastest cost-feasible path
-  closest_constrained_path(g, source, destination, budget);
+  closest_constrained_path(g, source, destination, budget, config);
 
   return 0;
 }
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "label_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Dominance policies for labelSettingLoop().
+//
+// The loop queues labels by (cost, time) and settles a popped label only
+// when it is faster than frontierTail[v]. An approximate policy sits on
+// both ends of the queue: open() sees every label the loop is about to
+// push and says what to push instead, and settle() sees every popped label
+// the frontier test lets through and names the path it stands for.
+
+// Exact Pareto dominance: each queued label is one path, pushed and
+// settled as is, with no hooks in the loop.
+struct ExactDominance {
+    static constexpr bool approximate = false;
+
+    static void reset() {}
+};
+
+// (1 + epsilon)-dominance with apex bookkeeping, after A*pex (Zhang et al.,
+// ICAPS 2022). A queued entry stands for a set of paths to one vertex: an
+// apex, the component-wise minimum of their (cost, time), and one of them,
+// the representative, whose (cost, time) is within a factor of 1 + epsilon
+// of the apex. The loop orders and prunes entries by their apex, exactly as
+// it does plain labels, but settles the representative.
+//
+// Entries merge only while both are still queued, so the merged apex
+// reaches every label later extended from the survivor and the factor
+// never compounds along a path: every path the exact search would have
+// found is matched by a settled representative no more expensive and at
+// most 1 + epsilon times as slow. Costs are kept exact (the cheaper entry
+// always represents the merge), so a representative never breaks a budget
+// that its apex meets; only times are approximated. A merge keeps the
+// cheaper entry when its time is within 1 + epsilon of the merged apex.
+//
+// Queue entries carry an entry index (in place of the parent label) that
+// stays valid for the search; entries absorbed by another are marked dead,
+// and an entry whose apex drops is queued again under the lower key, so
+// stale queue entries are skipped at settle(). Reusable across searches:
+// reset() drops the previous one's entries.
+template<typename VertexT, typename WeightT>
+class EpsilonDominance {
+private:
+    struct Entry {
+        WeightT cost;
+        WeightT apexTime;
+        WeightT pathTime;
+        uint32_t parent; // settled label the representative extends
+        bool queued;
+    };
+
+    double scale;
+    vector<Entry> entries;
+    vector<vector<uint32_t>> queuedAt; // queued entries per vertex (dead ones removed lazily)
+    vector<VertexT> touched;
+    uint64_t merges = 0;
+
+    // Whether a representative of (cost, time) may stand for apexTime
+    bool represents(const WeightT& time, const WeightT& apexTime) const {
+        return double(time) <= scale * double(apexTime);
+    }
+
+public:
+    static constexpr bool approximate = true;
+
+    EpsilonDominance(double epsilon = 0, int numVertices = 0) : scale(1 + epsilon), queuedAt(numVertices) {}
+
+    void reset() {
+        for (const VertexT& v : touched) {
+            queuedAt[v].clear();
+        }
+        touched.clear();
+        entries.clear();
+        merges = 0;
+    }
+
+    // A path to v extending settled label parent, with apex (cost, time)
+    // equal to itself and the given path time, is about to be queued. Merges
+    // it with the entries queued at v where the cheaper one can represent
+    // both. Returns whether an entry must be queued, naming it in item and
+    // its apex in apex: the new entry, or an older one that absorbed it and
+    // whose apex dropped.
+    template<typename PathSignature>
+    bool open(const VertexT& v, uint32_t parent, const WeightT& pathTime, PathSignature& apex, uint32_t& item) {
+        auto& queued = queuedAt[v];
+        if (queued.empty()) {
+            touched.push_back(v);
+        }
+        Entry fresh{apex.cost, apex.time, pathTime, parent, true};
+        for (size_t k = 0; k < queued.size();) {
+            Entry& other = entries[queued[k]];
+            if (!other.queued) {
+                queued[k] = queued.back();
+                queued.pop_back();
+                continue;
+            }
+            WeightT apexTime = min(fresh.apexTime, other.apexTime);
+            bool otherFirst = other.cost < fresh.cost || (other.cost == fresh.cost && other.pathTime <= fresh.pathTime);
+            if (otherFirst && represents(other.pathTime, apexTime)) {
+                // The older entry absorbs the new one; queue it again only
+                // if its apex dropped.
+                ++merges;
+                if (apexTime == other.apexTime) {
+                    return false;
+                }
+                other.apexTime = apexTime;
+                item = queued[k];
+                apex = PathSignature(other.cost, apexTime);
+                return true;
+            }
+            if (!otherFirst && represents(fresh.pathTime, apexTime)) {
+                ++merges;
+                fresh.apexTime = apexTime;
+                other.queued = false;
+                queued[k] = queued.back();
+                queued.pop_back();
+                continue;
+            }
+            ++k;
+        }
+        item = uint32_t(entries.size());
+        entries.push_back(fresh);
+        queued.push_back(item);
+        apex = PathSignature(fresh.cost, fresh.apexTime);
+        return true;
+    }
+
+    // A popped queue entry with apex label passed the frontier test. Returns
+    // false for a stale one (absorbed, or queued again under a lower apex);
+    // otherwise closes the entry and names the label the representative
+    // extends and the representative's time. The search root carries
+    // NO_LABEL and stands for itself.
+    template<typename PathSignature>
+    bool settle(uint32_t item, const PathSignature& label, uint32_t& parent, WeightT& pathTime) {
+        if (item == NO_LABEL) {
+            parent = NO_LABEL;
+            pathTime = label.time;
+            return true;
+        }
+        Entry& entry = entries[item];
+        if (!entry.queued || entry.apexTime != label.time) {
+            return false;
+        }
+        entry.queued = false;
+        parent = entry.parent;
+        pathTime = entry.pathTime;
+        return true;
+    }
+
+    double epsilon() const {
+        return scale - 1;
+    }
+
+    // Queued entries absorbed into another, in the last search
+    uint64_t merged() const {
+        return merges;
+    }
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "bounds.h"
+#include "dominance.h"
+#include "graph.h"
+#include "hierarchy.h"
+#include "lagrangian.h"
+#include "parallel_pareto.h"
+#include "pareto.h"
+#include <string>
+
+using namespace std;
+
+// The point-to-point engines behind one interface: a SearchConfig picks
+// the engine and its options, a Workspace holds one thread's reusable
+// search state, and constrained_query() / constrained_frontier() run a
+// query with them. Shared by cpath and the benchmark harness.
+
+// Which search answers point-to-point queries
+enum class Engine { LabelSetting, LowerBounded, Bidirectional, Parallel, Hierarchy };
+
+// The --engine name of an engine
+inline const char *engine_name(Engine engine) {
+    switch (engine) {
+    case Engine::LabelSetting:
+        return "label";
+    case Engine::Bidirectional:
+        return "bidir";
+    case Engine::Parallel:
+        return "parallel";
+    case Engine::Hierarchy:
+        return "ch";
+    default:
+        return "astar";
+    }
+}
+
+// The engine an --engine name selects; false for an unknown name
+inline bool parse_engine(const string &name, Engine &engine) {
+    for (Engine e : {Engine::LabelSetting, Engine::LowerBounded, Engine::Bidirectional, Engine::Parallel,
+                     Engine::Hierarchy}) {
+        if (name == engine_name(e)) {
+            engine = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+// How queries are searched, from the command line
+struct SearchConfig {
+    Engine engine = Engine::LowerBounded;
+    LabelQueue queue = LabelQueue::Auto;
+    int maxEdgeCost = 0; // of the loaded graph, for sizing bucket queues
+    LabelWindow<int> window; // of the loaded graph, for the parallel engine
+    int searchThreads = 1;   // workers inside one parallel search
+    const ContractionHierarchy<int, int> *hierarchy = nullptr; // for the ch engine
+    double epsilon = 0;      // > 0: (1 + epsilon)-dominance in label/astar searches
+    bool larac = true;       // try the Lagrangian fast path in exact astar queries
+    bool labelStats = false; // report frontier sizes on stderr
+    bool cheapest = false;   // least cost within a time limit, searched on the swapped graph
+    bool statsJson = false;  // one JSON line of search statistics per query on stderr
+    double loadMs = 0;       // time taken to load the graph, for those lines
+
+    bool usesLarac() const {
+        return larac && epsilon == 0 && engine == Engine::LowerBounded;
+    }
+
+    size_t bucketSpan(int budget) const {
+        return labelBucketSpan(queue, maxEdgeCost, budget, engine == Engine::LowerBounded);
+    }
+};
+
+// Search workspace for one thread: one state per search direction, the
+// lower bounds, the epsilon-dominance record, the Lagrangian runs (with
+// the last query's outcome) and the parallel engine's worker threads,
+// started once and reused by every query. Parts an engine does not use
+// are left empty.
+struct Workspace {
+    graph<int, int>::GraphAlgorithmState forward;
+    graph<int, int>::GraphAlgorithmState backward;
+    LowerBounds<int, int> bounds;
+    EpsilonDominance<int, int> dominance;
+    LagrangianSearch<int, int> lagrangian;
+    LaracOutcome<int> larac;
+    WorkerPool workers;
+
+    Workspace(const graph<int, int> &g, const SearchConfig &config)
+        : forward(g.NumVertices()),
+          backward(config.engine == Engine::Bidirectional || config.engine == Engine::Hierarchy ? g.NumVertices() : 0),
+          bounds(config.engine == Engine::LowerBounded || config.engine == Engine::Parallel ? g.NumVertices() : 0),
+          dominance(config.epsilon, config.epsilon > 0 ? g.NumVertices() : 0),
+          lagrangian(config.usesLarac() ? g.NumVertices() : 0),
+          workers(config.engine == Engine::Parallel ? config.searchThreads : 1) {}
+};
+
+inline ConstrainedResult<int> constrained_query(const graph<int, int> &g, Workspace &ws,
+                                         const SearchConfig &config, int source, int destination,
+                                         int budget) {
+    ws.larac = LaracOutcome<int>();
+    switch (config.engine) {
+    case Engine::Bidirectional:
+        return bidirectionalParetoSearch(g, ws.forward, ws.backward, source, destination, budget);
+    case Engine::Hierarchy:
+        return hierarchyParetoSearch(*config.hierarchy, ws.forward, ws.backward, source, destination, budget);
+    case Engine::Parallel:
+        ws.bounds.compute(g, destination, budget);
+        return parallelParetoSearch(g, ws.forward, source, destination, budget, config.window, ws.workers,
+                                    ws.bounds, config.bucketSpan(budget));
+    case Engine::LowerBounded:
+        ws.bounds.compute(g, destination, budget);
+        if (config.epsilon > 0) {
+            return paretoSearch(g, ws.forward, source, destination, budget, ws.bounds,
+                                config.bucketSpan(budget), ws.dominance);
+        }
+        // Exact queries start from LARAC, which often answers outright and
+        // otherwise brackets the answer's time for the label search
+        if (config.usesLarac()) {
+            ws.larac = ws.lagrangian.solve(g, ws.forward, source, destination, budget, ws.bounds);
+            if (ws.larac.solved) {
+                return ws.larac.result;
+            }
+        }
+        return paretoSearch(g, ws.forward, source, destination, budget, ws.bounds,
+                            config.bucketSpan(budget), ExactDominance(), ws.larac.bracket);
+    default:
+        if (config.epsilon > 0) {
+            return paretoSearch(g, ws.forward, source, destination, budget, NoBounds(),
+                                config.bucketSpan(budget), ws.dominance);
+        }
+        return paretoSearch(g, ws.forward, source, destination, budget, NoBounds(),
+                            config.bucketSpan(budget));
+    }
+}
+
+// Destination frontier up to maxBudget, pruned by the cost bound when the
+// engine computes bounds. Hierarchy frontiers join two labels per entry,
+// so theirs come back without labels (see print_frontier() for paths).
+inline graph<int, int>::NonDominatedPathsSet constrained_frontier(const graph<int, int> &g, Workspace &ws,
+                                                           const SearchConfig &config, int source,
+                                                           int destination, int maxBudget) {
+    if (config.engine == Engine::Hierarchy) {
+        graph<int, int>::NonDominatedPathsSet frontier;
+        for (const auto &r : hierarchyFrontier(*config.hierarchy, ws.forward, ws.backward, source,
+                                               destination, maxBudget)) {
+            frontier.push_back(graph<int, int>::SettledPath(graph<int, int>::PathSignature(r.cost, r.time),
+                                                            NO_LABEL));
+        }
+        return frontier;
+    }
+    if (config.engine == Engine::Parallel) {
+        ws.bounds.compute(g, destination, maxBudget);
+        return parallelParetoFrontier(g, ws.forward, source, destination, maxBudget, config.window, ws.workers,
+                                      ws.bounds, config.bucketSpan(maxBudget));
+    }
+    if (config.engine == Engine::LowerBounded) {
+        ws.bounds.compute(g, destination, maxBudget);
+        if (config.epsilon > 0) {
+            return paretoFrontier(g, ws.forward, source, destination, maxBudget, ws.bounds,
+                                  config.bucketSpan(maxBudget), ws.dominance);
+        }
+        return paretoFrontier(g, ws.forward, source, destination, maxBudget, ws.bounds,
+                              config.bucketSpan(maxBudget));
+    }
+    if (config.epsilon > 0) {
+        return paretoFrontier(g, ws.forward, source, destination, maxBudget, NoBounds(),
+                              config.bucketSpan(maxBudget), ws.dominance);
+    }
+    return paretoFrontier(g, ws.forward, source, destination, maxBudget, NoBounds(),
+                          config.bucketSpan(maxBudget));
+}
+
+// Frontier sizes of the last search in ws, both directions together
+inline FrontierSizes search_frontier_sizes(const Workspace &ws) {
+    vector<size_t> sizes;
+    appendFrontierSizes(ws.forward, sizes);
+    appendFrontierSizes(ws.backward, sizes);
+    return summarizeFrontierSizes(move(sizes));
+}
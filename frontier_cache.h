@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+
+// Memory-bounded LRU cache of destination frontiers, keyed by
+// (source, destination).
+//
+// An entry holds the frontier one search computed up to some budget cap,
+// so it answers any budget up to that cap by binary search (see
+// fastestWithinBudget()); a larger budget is a miss, and the caller
+// recomputes with a higher cap and replaces the entry. A frontier costs
+// many times a pruned search, so a miss on an unknown pair leaves only a
+// frontier-less entry counting the pair's misses; the caller decides from
+// that count when the pair is hot enough to be worth a frontier. Entries
+// are charged for their frontier storage plus a fixed overhead, and the
+// least recently used ones are evicted once the total goes over the byte
+// limit, so the miss counters share the limit with the frontiers; the
+// statistics report the two kinds of entry apart. A limit of 0 disables
+// the cache.
+//
+// All members lock one mutex, so the batch workers can share a cache;
+// lookups answer under the lock instead of copying frontiers out.
+template<typename WeightT, typename Frontier>
+class FrontierCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;   // of cached frontiers
+        size_t frontiers = 0;     // pairs with a cached frontier
+        size_t frontierBytes = 0;
+        size_t pending = 0;       // frontier-less pairs counting misses
+        size_t pendingBytes = 0;
+    };
+
+    // The misses of a pair (this one included) and the largest budget they
+    // asked for, counted since its frontier was last computed
+    struct Miss {
+        uint32_t count = 0;
+        WeightT largestBudget{};
+    };
+
+private:
+    struct Entry {
+        uint64_t key;
+        bool cached;
+        WeightT cap;
+        Frontier frontier;
+        size_t bytes;
+        uint32_t misses;
+        WeightT largestBudget;
+    };
+
+    // Bookkeeping charged per entry on top of the frontier itself: the
+    // list node and the index slot
+    static const size_t ENTRY_OVERHEAD = sizeof(Entry) + 4 * sizeof(void*) + 2 * sizeof(uint64_t);
+
+    size_t limit;
+    list<Entry> entries; // most recently used first
+    unordered_map<uint64_t, typename list<Entry>::iterator> index;
+    Stats stats;
+    mutable mutex lock;
+
+    template<typename VertexT>
+    static uint64_t keyOf(const VertexT& source, const VertexT& destination) {
+        return uint64_t(uint32_t(source)) << 32 | uint32_t(destination);
+    }
+
+    size_t totalBytes() const {
+        return stats.frontierBytes + stats.pendingBytes;
+    }
+
+    // Counts an entry into the statistics, or out of them
+    void account(const Entry& entry, bool add) {
+        size_t& count = entry.cached ? stats.frontiers : stats.pending;
+        size_t& bytes = entry.cached ? stats.frontierBytes : stats.pendingBytes;
+        if (add) {
+            ++count;
+            bytes += entry.bytes;
+        } else {
+            --count;
+            bytes -= entry.bytes;
+        }
+    }
+
+    void erase(typename list<Entry>::iterator it) {
+        account(*it, false);
+        index.erase(it->key);
+        entries.erase(it);
+    }
+
+    void evictOver(size_t bytes) {
+        while (totalBytes() > bytes && !entries.empty()) {
+            stats.evictions += entries.back().cached;
+            erase(prev(entries.end()));
+        }
+    }
+
+    void pushFront(Entry entry) {
+        evictOver(limit - entry.bytes);
+        account(entry, true);
+        index[entry.key] = entries.insert(entries.begin(), move(entry));
+    }
+
+public:
+    explicit FrontierCache(size_t byteLimit) : limit(byteLimit) {}
+
+    bool enabled() const {
+        return limit > 0;
+    }
+
+    // On a hit (a cached frontier whose cap covers budget) calls
+    // answer(frontier) and returns true. On a miss counts it against the
+    // pair, starting a frontier-less entry for an unknown one, and returns
+    // false, describing the pair in *miss when given.
+    template<typename VertexT, typename Answer>
+    bool lookup(const VertexT& source, const VertexT& destination, const WeightT& budget, Answer&& answer,
+                Miss* miss = nullptr) {
+        uint64_t key = keyOf(source, destination);
+        lock_guard<mutex> guard(lock);
+        auto it = index.find(key);
+        if (it != index.end() && it->second->cached && !(it->second->cap < budget)) {
+            ++stats.hits;
+            entries.splice(entries.begin(), entries, it->second);
+            answer(it->second->frontier);
+            return true;
+        }
+        ++stats.misses;
+        Miss seen;
+        if (it != index.end()) {
+            Entry& entry = *it->second;
+            entry.largestBudget = max(entry.largestBudget, budget);
+            seen = Miss{++entry.misses, entry.largestBudget};
+            entries.splice(entries.begin(), entries, it->second);
+        } else {
+            seen = Miss{1, budget};
+            if (ENTRY_OVERHEAD <= limit) {
+                pushFront(Entry{key, false, WeightT{}, Frontier(), ENTRY_OVERHEAD, 1, budget});
+            }
+        }
+        if (miss != nullptr) {
+            *miss = seen;
+        }
+        return false;
+    }
+
+    // Stores the frontier of (source, destination) computed up to cap,
+    // replacing any older entry. A frontier bigger than the whole limit is
+    // not stored.
+    template<typename VertexT>
+    void insert(const VertexT& source, const VertexT& destination, const WeightT& cap, Frontier frontier) {
+        if (!enabled()) {
+            return;
+        }
+        size_t bytes = ENTRY_OVERHEAD + frontier.capacity() * sizeof(typename Frontier::value_type);
+        uint64_t key = keyOf(source, destination);
+        lock_guard<mutex> guard(lock);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            erase(it->second);
+        }
+        if (bytes > limit) {
+            return;
+        }
+        pushFront(Entry{key, true, cap, move(frontier), bytes, 0, cap});
+    }
+
+    // Drops every entry, e.g. once edge weights change under the frontiers
+    void clear() {
+        lock_guard<mutex> guard(lock);
+        entries.clear();
+        index.clear();
+        stats.frontiers = stats.frontierBytes = 0;
+        stats.pending = stats.pendingBytes = 0;
+    }
+
+    Stats statistics() const {
+        lock_guard<mutex> guard(lock);
+        return stats;
+    }
+};
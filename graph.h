@@ -1,14 +1,79 @@
 #pragma once
 
+#include "bucket_queue.h"
+#include "label_pool.h"
+#include "search_stats.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 #include <set>
 #include <map>
+#include <memory>
 #include <queue>
+#include <type_traits>
 
 using namespace std;
 
+// A (cost, time) label key as one 64-bit integer, for integer weight types
+// of up to 32 bits: the high word orders by cost and the low word by time,
+// each mapped to an unsigned word in the same order (signed types flip the
+// sign bit). Comparing two keys is then a single integer compare instead
+// of a compare and branch per field, and the queues' comparisons are what
+// the label loops spend most of their branch mispredictions on. Wider or
+// floating-point weights are compared field by field.
+template<typename WeightT>
+struct PackedLabelKey {
+    static constexpr bool enabled = is_integral<WeightT>::value && sizeof(WeightT) <= 4;
+
+    static uint64_t word(const WeightT& w) {
+        using Unsigned = make_unsigned_t<WeightT>;
+        uint32_t bits = uint32_t(Unsigned(w));
+        if constexpr (is_signed<WeightT>::value) {
+            bits ^= uint32_t(1) << (8 * sizeof(WeightT) - 1);
+        }
+        return bits;
+    }
+
+    // Increasing cost, ties by increasing time
+    static uint64_t pack(const WeightT& cost, const WeightT& time) {
+        return word(cost) << 32 | word(time);
+    }
+
+    // Increasing cost, ties by decreasing time
+    static uint64_t packTimeDescending(const WeightT& cost, const WeightT& time) {
+        return word(cost) << 32 | uint32_t(~word(time));
+    }
+};
+
+// The largest cost or time a label may have. The searches keep the type's
+// maximum for "none": no label at a vertex yet (frontierTail), no
+// destination time yet, no bound. So edge weights are loaded only below it
+// (see loadFrozen()) and path sums are kept below it.
+template<typename WeightT>
+constexpr WeightT largestLabelWeight() {
+    return numeric_limits<WeightT>::max() - 1;
+}
+
+// Path sum tests for non-negative weights that cannot overflow: whether
+// a + b is at most (sumWithin) or below (sumBelow) limit, compared as
+// b against limit - a, so limits up to the type's maximum work and a sum
+// that would not fit the type fails the test instead of wrapping. Either
+// way the sum is at most largestLabelWeight(). The searches relax edges
+// only through these, which leaves every label they keep representable.
+template<typename WeightT>
+inline bool sumWithin(const WeightT& a, const WeightT& b, const WeightT& limit) {
+    const WeightT cap = min(limit, largestLabelWeight<WeightT>());
+    return a <= cap && b <= cap - a;
+}
+
+template<typename WeightT>
+inline bool sumBelow(const WeightT& a, const WeightT& b, const WeightT& limit) {
+    return a < limit && b < limit - a;
+}
+
 template<typename VertexT, typename WeightT>
 class graph {
 private:
@@ -19,6 +84,122 @@ private:
     map<VertexT, map<VertexT, Edge>> adjList;
     vector<VertexT> vertices;
 
+public:
+
+    // Compressed sparse row (CSR) adjacency, built once by freeze() or
+    // loadFrozen(), or attached from a snapshot. Edges leaving v live at
+    // indices offsets[v] .. offsets[v+1]-1 of the target/cost/time arrays.
+    // This is a read-only view; the arrays are owned by the graph's storage
+    // (its own vectors, or a mapped snapshot file).
+    struct CSR {
+        size_t numVertices = 0;
+        size_t numEdges = 0;
+        const uint64_t* offsets = nullptr;
+        const VertexT* targets = nullptr;
+        const WeightT* costs = nullptr;
+        const WeightT* times = nullptr;
+    };
+
+    // One outgoing edge as seen by a search: (neighbor, cost, time).
+    struct EdgeRef {
+        VertexT target;
+        WeightT cost;
+        WeightT time;
+    };
+
+    // Forward iterator over a CSR row. Dereferencing reads the three arrays
+    // in place; nothing is allocated or looked up.
+    class EdgeIterator {
+    private:
+        const VertexT* targets;
+        const WeightT* costs;
+        const WeightT* times;
+        size_t e;
+
+    public:
+        EdgeIterator(const VertexT* t, const WeightT* c, const WeightT* w, size_t i)
+            : targets(t), costs(c), times(w), e(i) {}
+
+        EdgeRef operator*() const {
+            return EdgeRef{targets[e], costs[e], times[e]};
+        }
+
+        EdgeIterator& operator++() {
+            ++e;
+            return *this;
+        }
+
+        bool operator==(const EdgeIterator& other) const {
+            return e == other.e;
+        }
+
+        bool operator!=(const EdgeIterator& other) const {
+            return e != other.e;
+        }
+    };
+
+    class EdgeRange {
+    private:
+        EdgeIterator first;
+        EdgeIterator last;
+
+    public:
+        EdgeRange(EdgeIterator f, EdgeIterator l) : first(f), last(l) {}
+
+        EdgeIterator begin() const {
+            return first;
+        }
+
+        EdgeIterator end() const {
+            return last;
+        }
+    };
+
+private:
+    // Backing store for CSR arrays the graph builds itself.
+    struct CSRArrays {
+        vector<uint64_t> offsets;
+        vector<VertexT> targets;
+        vector<WeightT> costs;
+        vector<WeightT> times;
+    };
+
+    CSR csrData;
+    shared_ptr<const void> csrStorage; // keeps whatever csrData points into alive
+    shared_ptr<CSRArrays> ownArrays;   // csrStorage when it is arrays this graph built
+    bool frozen = false;
+
+    void adoptArrays(shared_ptr<CSRArrays> arrays) {
+        CSR view;
+        view.numVertices = arrays->offsets.size() - 1;
+        view.numEdges = arrays->targets.size();
+        view.offsets = arrays->offsets.data();
+        view.targets = arrays->targets.data();
+        view.costs = arrays->costs.data();
+        view.times = arrays->times.data();
+        attachFrozen(view, arrays);
+        ownArrays = move(arrays);
+    }
+
+    // Arrays updateEdge() may write: the graph's own, unless another graph
+    // shares them (a copy, or a swappedCriteria() view). Shared or mapped
+    // arrays are copied first, so an update never shows through another
+    // graph or reaches a snapshot file.
+    CSRArrays& writableArrays() {
+        // csrStorage and ownArrays are the two references an unshared graph holds
+        if (!ownArrays || ownArrays.use_count() > 2) {
+            const CSR& c = csrData;
+            auto arrays = make_shared<CSRArrays>();
+            arrays->offsets.assign(c.offsets, c.offsets + c.numVertices + 1);
+            arrays->targets.assign(c.targets, c.targets + c.numEdges);
+            arrays->costs.assign(c.costs, c.costs + c.numEdges);
+            arrays->times.assign(c.times, c.times + c.numEdges);
+            frozen = false;
+            adoptArrays(arrays);
+        }
+        return *ownArrays;
+    }
+
 public:
 
     struct PathSignature {
@@ -28,48 +209,133 @@ public:
         PathSignature(WeightT c, WeightT t) : cost(c), time(t) {}
 
         bool operator<(const PathSignature& other) const {
-            return (cost < other.cost) || (cost == other.cost && time > other.time);
+            if constexpr (PackedLabelKey<WeightT>::enabled) {
+                return PackedLabelKey<WeightT>::packTimeDescending(cost, time) <
+                       PackedLabelKey<WeightT>::packTimeDescending(other.cost, other.time);
+            } else {
+                return (cost < other.cost) || (cost == other.cost && time > other.time);
+            }
         }
     };
 
+    // A queued label: its key, its vertex and the settled label (index in
+    // the search's LabelPool) it extends.
     struct HeapElement {
         PathSignature pathSignature;
         VertexT vertex;
+        uint32_t parent;
 
-        HeapElement(const PathSignature& ps, const VertexT& v) : pathSignature(ps), vertex(v) {}
+        HeapElement(const PathSignature& ps, const VertexT& v, uint32_t p = NO_LABEL)
+            : pathSignature(ps), vertex(v), parent(p) {}
 
+        // priority_queue is a max-heap, so "less" here means "popped later":
+        // the heap yields labels in increasing cost, ties broken by smaller time.
         bool operator<(const HeapElement& other) const {
-            return pathSignature < other.pathSignature;
+            if constexpr (PackedLabelKey<WeightT>::enabled) {
+                return PackedLabelKey<WeightT>::pack(other.pathSignature.cost, other.pathSignature.time) <
+                       PackedLabelKey<WeightT>::pack(pathSignature.cost, pathSignature.time);
+            } else {
+                if (pathSignature.cost != other.pathSignature.cost) {
+                    return pathSignature.cost > other.pathSignature.cost;
+                }
+                return pathSignature.time > other.pathSignature.time;
+            }
         }
     };
 
-    using NonDominatedPathsSet = vector<PathSignature>;
+    // An entry of S[v]: a settled label's signature and its index in the
+    // search's LabelPool, from which its path can be read back.
+    struct SettledPath : PathSignature {
+        uint32_t label;
+
+        SettledPath(const PathSignature& ps, uint32_t l) : PathSignature(ps), label(l) {}
+    };
+
+    using NonDominatedPathsSet = vector<SettledPath>;
 
+    // Per-search workspace. Reusing one across queries (e.g. one per worker
+    // thread in batch mode) keeps the queues' and the S[v] vectors'
+    // capacity, and initialize() only clears the S[v] sets the previous
+    // query touched. A search uses either the binary heap or the bucket
+    // queue (see bucket_queue.h), chosen by initialize().
     struct GraphAlgorithmState {
         priority_queue<HeapElement> priorityQueue;
+        BucketQueue<HeapElement> bucketQueue;
         vector<NonDominatedPathsSet> nonDominatedPaths;
+        vector<VertexT> touchedVertices;
+        // frontierTail[v] mirrors S[v].back().time (max() while S[v] is
+        // empty) in one flat array, so the dominance pre-check reads one
+        // word per neighbor instead of going through the S[v] vector.
+        // max() cannot collide with a real tail: label times stay at or
+        // below largestLabelWeight(), and `tail <= time` never holds for it.
+        vector<WeightT> frontierTail;
+        LabelPool<VertexT> labels;
+        vector<uint32_t> relaxKeep; // scratch for relaxFilter()
+        SearchCounters counters;    // of the last search (see search_stats.h)
 
-        GraphAlgorithmState(int numVertices) : nonDominatedPaths(numVertices) {}
+        GraphAlgorithmState(int numVertices)
+            : nonDominatedPaths(numVertices), frontierTail(numVertices, numeric_limits<WeightT>::max()) {}
 
-        void initialize(const VertexT& source) {
-            priorityQueue = priority_queue<HeapElement>();
-            priorityQueue.push(HeapElement(PathSignature(0, 0), source));
+        // S[source] starts empty: the (0, 0) label is appended when it is
+        // popped, like every other label. Searches that key the queue by
+        // something other than the label itself pass the source's key.
+        // A non-zero bucketSpan seeds the bucket queue instead of the heap.
+        void initialize(const VertexT& source, const PathSignature& sourceKey = PathSignature(0, 0),
+                        size_t bucketSpan = 0) {
+            while (!priorityQueue.empty()) {
+                priorityQueue.pop();
+            }
+            if (bucketSpan > 0) {
+                bucketQueue.reset(bucketSpan);
+                bucketQueue.push(HeapElement(sourceKey, source));
+            } else {
+                priorityQueue.push(HeapElement(sourceKey, source));
+            }
 
-            for (auto& paths : nonDominatedPaths) {
-                paths.clear();
+            for (const VertexT& v : touchedVertices) {
+                nonDominatedPaths[v].clear();
+                frontierTail[v] = numeric_limits<WeightT>::max();
             }
+            touchedVertices.clear();
+            labels.clear();
+            counters = SearchCounters();
+            counters.onPush(1);
+        }
+
+        // Appends a non-dominated label to S[v] (the caller has checked it
+        // against S[v].back()), records it in the label pool as an extension
+        // of parent, and returns its index there.
+        uint32_t appendPath(const VertexT& v, const PathSignature& ps, uint32_t parent) {
+            auto& paths = nonDominatedPaths[v];
+            if (paths.empty()) {
+                touchedVertices.push_back(v);
+            }
+            uint32_t label = labels.add(v, parent);
+            paths.push_back(SettledPath(ps, label));
+            frontierTail[v] = ps.time;
+            return label;
+        }
 
-            nonDominatedPaths[source].push_back(PathSignature(0, 0));
+        // Vertices of a settled label's path, the search's source first.
+        // Valid until the next initialize().
+        vector<VertexT> pathTo(uint32_t label) const {
+            return labels.path(label);
         }
     };
 
     graph() {}
 
     int NumVertices() const {
+        if (frozen) {
+            return csrData.numVertices;
+        }
         return adjList.size();
     }
 
     int NumEdges() const {
+        if (frozen) {
+            return csrData.numEdges;
+        }
         int count = 0;
         for (const auto& i : adjList) {
             count += i.second.size();
@@ -78,6 +344,9 @@ public:
     }
 
     bool addVertex(const VertexT& v) {
+        if (frozen) {
+            throw logic_error("graph: cannot add vertices after freeze()");
+        }
         if (adjList.count(v) > 0) {
             return false; // Vertex already exists
         }
@@ -87,6 +356,9 @@ public:
     }
 
     bool addEdge(const VertexT& from, const VertexT& to, const WeightT& cost, const WeightT& time) {
+        if (frozen) {
+            throw logic_error("graph: cannot add edges after freeze()");
+        }
         addVertex(from);
         addVertex(to);
     
@@ -96,7 +368,21 @@ public:
         return true;
     }
 
+    // Single-edge lookup. Searches should iterate edges(v) instead.
     bool getWeight(const VertexT& from, const VertexT& to, WeightT& cost, WeightT& time) const {
+        if (frozen) {
+            if (from < 0 || from >= NumVertices()) {
+                return false;
+            }
+            for (const EdgeRef& edge : edges(from)) {
+                if (edge.target == to) {
+                    cost = edge.cost;
+                    time = edge.time;
+                    return true;
+                }
+            }
+            return false;
+        }
         auto it = adjList.find(from);
         if (it != adjList.end() && it->second.find(to) != it->second.end()) {
             const Edge& edgeData = it->second.at(to);
@@ -107,8 +393,18 @@ public:
         return false;
     }
 
+    // Builds a fresh set on every call; kept for callers outside the search
+    // loops. Searches should iterate edges(v) instead.
     set<VertexT> neighbors(const VertexT& v) const {
         set<VertexT> S;
+        if (frozen) {
+            if (v >= 0 && v < NumVertices()) {
+                for (const EdgeRef& edge : edges(v)) {
+                    S.insert(edge.target);
+                }
+            }
+            return S;
+        }
         auto it = adjList.find(v);
         if (it != adjList.end()) {
             for (const auto& pair : it->second) {
@@ -118,7 +414,216 @@ public:
         return S;
     }
 
+    // Converts the adjacency maps into CSR arrays and releases the maps.
+    // Vertices must be integers 0..max; the graph is read-only afterwards.
+    void freeze() {
+        static_assert(is_integral<VertexT>::value, "freeze() needs integer vertex ids");
+        if (frozen) {
+            return;
+        }
+        size_t numVertices = adjList.empty() ? 0 : size_t(adjList.rbegin()->first) + 1;
+        size_t numEdges = NumEdges();
+        auto arrays = make_shared<CSRArrays>();
+
+        arrays->offsets.assign(numVertices + 1, 0);
+        arrays->targets.reserve(numEdges);
+        arrays->costs.reserve(numEdges);
+        arrays->times.reserve(numEdges);
+
+        for (const auto& row : adjList) {
+            arrays->offsets[row.first + 1] = row.second.size();
+        }
+        for (size_t v = 0; v < numVertices; ++v) {
+            arrays->offsets[v + 1] += arrays->offsets[v];
+        }
+        // adjList is an ordered map, so this fills the arrays row by row.
+        for (const auto& row : adjList) {
+            for (const auto& edge : row.second) {
+                arrays->targets.push_back(edge.first);
+                arrays->costs.push_back(edge.second.cost);
+                arrays->times.push_back(edge.second.time);
+            }
+        }
+
+        map<VertexT, map<VertexT, Edge>>().swap(adjList);
+        vector<VertexT>().swap(vertices);
+        adoptArrays(arrays);
+    }
+
+    // Builds the frozen CSR arrays directly from an edge stream, without
+    // going through the adjacency maps. forEachEdge(emit) must call
+    // emit(from, to, cost, time) once per input edge; it is run twice, once
+    // to count degrees and once to fill the rows. Like addEdge(), every edge
+    // is stored in both directions. Unlike addEdge(), a repeated (from, to)
+    // pair is kept as a parallel edge rather than overwritten.
+    // numVertices presizes the vertex range; larger ids still grow it.
+    // Negative vertex ids, negative weights (which every search assumes
+    // away) and weights of WeightT's maximum (the searches' "none", see
+    // largestLabelWeight()) are rejected with invalid_argument, as is a
+    // vertex count that does not fit VertexT.
+    // Whether w can be an edge weight: non-negative and at most
+    // largestLabelWeight()
+    static bool validWeight(const WeightT& w) {
+        return !(w < WeightT(0)) && w <= largestLabelWeight<WeightT>();
+    }
+
+    template<typename EdgeSource>
+    void loadFrozen(size_t numVertices, const EdgeSource& forEachEdge) {
+        static_assert(is_integral<VertexT>::value, "loadFrozen() needs integer vertex ids");
+        if (frozen || !adjList.empty()) {
+            throw logic_error("graph: loadFrozen() needs an empty graph");
+        }
+        if (numVertices > size_t(numeric_limits<VertexT>::max())) {
+            throw invalid_argument("graph: vertex count out of range");
+        }
+        auto arrays = make_shared<CSRArrays>();
+        vector<uint64_t>& offsets = arrays->offsets;
+
+        // Pass 1: count each vertex's degree in offsets[v]. The extra slot
+        // at the end will hold the total.
+        offsets.assign(numVertices + 1, 0);
+        forEachEdge([&](const VertexT& from, const VertexT& to, const WeightT& cost, const WeightT& time) {
+            if constexpr (is_signed<VertexT>::value) {
+                if (from < 0 || to < 0) {
+                    throw invalid_argument("graph: negative vertex id");
+                }
+            }
+            if (!validWeight(cost) || !validWeight(time)) {
+                throw invalid_argument("graph: edge weight out of range");
+            }
+            size_t needed = size_t(max(from, to)) + 2;
+            if (offsets.size() < needed) {
+                offsets.resize(needed, 0);
+            }
+            ++offsets[from];
+            if (from != to) {
+                ++offsets[to];
+            }
+        });
+
+        // Inclusive prefix sum: offsets[v] is now one past the end of row v.
+        size_t n = offsets.size() - 1;
+        for (size_t v = 1; v < n; ++v) {
+            offsets[v] += offsets[v - 1];
+        }
+        size_t numEdges = n > 0 ? offsets[n - 1] : 0;
+        offsets[n] = numEdges;
+        arrays->targets.resize(numEdges);
+        arrays->costs.resize(numEdges);
+        arrays->times.resize(numEdges);
+
+        // Pass 2: fill each row back to front. Decrementing the end pointers
+        // leaves offsets[v] at the start of row v, so no cursor array is needed.
+        auto place = [&](const VertexT& from, const VertexT& to, const WeightT& cost, const WeightT& time) {
+            size_t e = --offsets[from];
+            arrays->targets[e] = to;
+            arrays->costs[e] = cost;
+            arrays->times[e] = time;
+        };
+        forEachEdge([&](const VertexT& from, const VertexT& to, const WeightT& cost, const WeightT& time) {
+            place(from, to, cost, time);
+            if (from != to) {
+                place(to, from, cost, time);
+            }
+        });
+
+        adoptArrays(arrays);
+    }
+
+    // Freezes the graph on CSR arrays that live somewhere else, e.g. in a
+    // mapped snapshot file. owner is held for as long as the graph uses view.
+    void attachFrozen(const CSR& view, shared_ptr<const void> owner) {
+        if (frozen || !adjList.empty()) {
+            throw logic_error("graph: attachFrozen() needs an empty graph");
+        }
+        csrData = view;
+        csrStorage = move(owner);
+        ownArrays.reset();
+        frozen = true;
+    }
+
+    // Sets the cost and time of the edge between from and to, in place and
+    // in both directions; like addEdge(), parallel copies all get the new
+    // weights. Returns false (changing nothing) when there is no such edge.
+    // Searches running on the graph must not overlap the update, and
+    // workspaces keyed to the old weights (frontier caches, hierarchies)
+    // are the caller's to drop or repair (see incremental.h).
+    bool updateEdge(const VertexT& from, const VertexT& to, const WeightT& cost, const WeightT& time) {
+        const CSR& c = csr();
+        auto has = [&](const VertexT& u, const VertexT& v) {
+            return size_t(u) < c.numVertices &&
+                   find(c.targets + c.offsets[u], c.targets + c.offsets[u + 1], v) != c.targets + c.offsets[u + 1];
+        };
+        if (!has(from, to)) {
+            return false;
+        }
+        CSRArrays& arrays = writableArrays();
+        for (const auto& [u, v] : {pair<VertexT, VertexT>(from, to), pair<VertexT, VertexT>(to, from)}) {
+            for (uint64_t e = arrays.offsets[u]; e < arrays.offsets[u + 1]; ++e) {
+                if (arrays.targets[e] == v) {
+                    arrays.costs[e] = cost;
+                    arrays.times[e] = time;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool isFrozen() const {
+        return frozen;
+    }
+
+    const CSR& csr() const {
+        if (!frozen) {
+            throw logic_error("graph: csr() called before freeze()");
+        }
+        return csrData;
+    }
+
+    // The same frozen graph with the two criteria exchanged: edges(v) reports
+    // each edge's time as its cost and its cost as its time. The CSR arrays
+    // are shared, not copied, so every search that minimizes time within a
+    // cost budget answers the dual question (least cost within a time limit)
+    // on the swapped graph, searching in time order and pruning by the limit.
+    graph swappedCriteria() const {
+        CSR view = csr();
+        swap(view.costs, view.times);
+        graph swapped;
+        swapped.attachFrozen(view, csrStorage);
+        return swapped;
+    }
+
+    // Allocation-free view of the edges leaving v, for use in search loops:
+    //
+    //     for (const auto& edge : g.edges(v)) { edge.target, edge.cost, edge.time }
+    //
+    // The graph must be frozen and v must be in 0..NumVertices()-1.
+    EdgeRange edges(const VertexT& v) const {
+        const CSR& c = csr();
+        return EdgeRange(EdgeIterator(c.targets, c.costs, c.times, c.offsets[v]),
+                         EdgeIterator(c.targets, c.costs, c.times, c.offsets[v + 1]));
+    }
+
+    // Largest edge cost, by a scan of the frozen cost array. Sizes the
+    // bucket queue, so callers compute it once per graph, not per query.
+    WeightT maxEdgeCost() const {
+        const CSR& c = csr();
+        WeightT largest = 0;
+        for (size_t e = 0; e < c.numEdges; ++e) {
+            largest = max(largest, c.costs[e]);
+        }
+        return largest;
+    }
+
+    // A frozen graph's vertices are exactly 0..NumVertices()-1.
     vector<VertexT> getVertices() const {
+        if (frozen) {
+            vector<VertexT> ids(NumVertices());
+            for (size_t v = 0; v < ids.size(); ++v) {
+                ids[v] = VertexT(v);
+            }
+            return ids;
+        }
         return vertices;
     }
 
@@ -131,20 +636,29 @@ public:
 
         output << endl;
         output << "**Vertices:" << endl;
+        vector<VertexT> ids = this->getVertices();
         for (int i = 0; i < this->NumVertices(); ++i) {
-            output << " " << i << ". " << this->vertices[i] << endl;
+            output << " " << i << ". " << ids[i] << endl;
         }
-        int curRow = 0;
+        // A frozen graph's edges are in the CSR arrays; adjList is empty
         output << endl;
         output << "**Edges:" << endl;
-        for (auto const &i : adjList) {
-            output << " row " << curRow << ": "; curRow++;
-            for (auto const &j : adjList) {
-                if (adjList.at(i.first).count(j.first) == 0) {
+        for (size_t row = 0; row < ids.size(); ++row) {
+            map<VertexT, Edge> out;
+            if (frozen) {
+                for (const auto& edge : edges(ids[row])) {
+                    out.emplace(edge.target, Edge{edge.cost, edge.time});
+                }
+            } else if (adjList.count(ids[row]) != 0) {
+                out = adjList.at(ids[row]);
+            }
+            output << " row " << row << ": ";
+            for (const VertexT& column : ids) {
+                auto it = out.find(column);
+                if (it == out.end()) {
                     output << "F ";
                 } else {
-                    output << "(T," << adjList.at(i.first).at(j.first)
-                        << ") ";
+                    output << "(T," << it->second.cost << "," << it->second.time << ") ";
                 }
             }
             output << endl;
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "graph.h"
+#include "mapped_file.h"
+#include "snapshot.h"
+#include <cctype>
+#include <charconv>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+// Reads whitespace-separated numbers directly out of a character buffer
+// (typically a MappedFile) using from_chars; nothing is copied.
+class TextScanner {
+private:
+    const char* cur;
+    const char* end;
+
+public:
+    TextScanner(const char* data, size_t size) : cur(data), end(data + size) {}
+
+    // Parses the next number into value. Returns false at end of input or
+    // on a token that is not a number of type T.
+    template<typename T>
+    bool next(T& value) {
+        while (cur < end && isspace(static_cast<unsigned char>(*cur))) {
+            ++cur;
+        }
+        if (cur == end) {
+            return false;
+        }
+        auto [ptr, ec] = from_chars(cur, end, value);
+        if (ec != errc()) {
+            return false;
+        }
+        cur = ptr;
+        return true;
+    }
+
+    const char* position() const {
+        return cur;
+    }
+};
+
+// Parses the text edge-list format out of an already mapped file.
+//
+// The vertex count on the first line presizes the graph, and the edge
+// lines are streamed twice straight into the frozen CSR arrays (see
+// graph::loadFrozen), so no adjacency maps or edge lists are built along
+// the way. Parsing stops at the first line that is not "u v c t", as it
+// always has.
+template<typename VertexT, typename WeightT>
+bool parseTextGraph(const MappedFile& file, const string& filename, graph<VertexT, WeightT>& g) {
+    TextScanner header(file.data(), file.size());
+    size_t numVertices;
+    if (!header.next(numVertices)) {
+        cerr << "Error: " << filename << " does not start with a vertex count" << endl;
+        return false;
+    }
+
+    const char* edgesBegin = header.position();
+    size_t edgesSize = file.data() + file.size() - edgesBegin;
+    auto forEachEdge = [&](auto&& emit) {
+        TextScanner in(edgesBegin, edgesSize);
+        VertexT u, v;
+        WeightT c, t;
+        while (in.next(u) && in.next(v) && in.next(c) && in.next(t)) {
+            emit(u, v, c, t);
+        }
+    };
+
+    try {
+        g.loadFrozen(numVertices, forEachEdge);
+    } catch (const exception& e) {
+        cerr << "Error: " << filename << ": " << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+// Function to read the graph from a text file
+template<typename VertexT, typename WeightT>
+bool readGraphFromFile(const string &filename, graph<VertexT, WeightT> &g) {
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        cerr << "Error: Unable to open input file " << filename << endl;
+        return false;
+    }
+    return parseTextGraph(file, filename, g);
+}
+
+// Loads either a text edge list or a binary snapshot (see snapshot.h),
+// telling them apart by the snapshot magic bytes. A snapshot stays mapped
+// for the lifetime of the graph instead of being copied.
+template<typename VertexT, typename WeightT>
+bool loadGraph(const string& filename, graph<VertexT, WeightT>& g) {
+    auto file = make_shared<const MappedFile>(filename);
+    if (!file->isOpen()) {
+        cerr << "Error: Unable to open input file " << filename << endl;
+        return false;
+    }
+    if (isSnapshot(file->data(), file->size())) {
+        return attachSnapshot(file, filename, g);
+    }
+    return parseTextGraph(*file, filename, g);
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Seeded synthetic bicriteria graphs, for benchmarks and capacity tests.
+//
+// A GraphGenerator hands out each vertex's edges on request: edgesFrom(u,
+// emit) calls emit(u, v, cost, time) for the edges u owns (each undirected
+// edge has exactly one owner). Everything a vertex's edges depend on is
+// drawn from a generator seeded by (seed, u), so the edges come out the
+// same in any order, on any thread, on any platform: forEachEdge() is an
+// edge source for graph::loadFrozen(), which runs it twice, and cgen
+// formats ranges of vertices in parallel.
+
+// SplitMix64 (Steele et al., OOPSLA 2014): small, fast, and good enough to
+// draw weights from; unlike the std distributions its output is the same
+// everywhere.
+class SplitMix64 {
+private:
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double unit() {
+        return double(next() >> 11) * 0x1.0p-53;
+    }
+
+    // Uniform in [lo, hi]
+    int64_t uniform(int64_t lo, int64_t hi) {
+        return lo + int64_t(unit() * double(hi - lo + 1));
+    }
+};
+
+// The generator of one vertex (or other item) of a seeded graph
+inline SplitMix64 itemRng(uint64_t seed, uint64_t item) {
+    SplitMix64 mix(seed ^ (item * 0xd1b54a32d192ed03ULL));
+    return SplitMix64(mix.next());
+}
+
+// Edge weights: costs uniform in [1, maxWeight], and times that follow the
+// cost as closely as correlation says, from 1 (time equals cost) through 0
+// (independent of it) to -1 (time is maxWeight + 1 - cost). Anti-correlated
+// weights, where cheap edges are slow, grow the largest Pareto frontiers.
+struct WeightModel {
+    int maxWeight = 100;
+    double correlation = 0;
+
+    // A time for an edge of the given cost
+    int time(int cost, SplitMix64& rng) const {
+        double follow = correlation >= 0 ? cost : maxWeight + 1 - cost;
+        double weight = fabs(correlation);
+        double t = weight * follow + (1 - weight) * double(rng.uniform(1, maxWeight));
+        return max(1, int(lround(t)));
+    }
+
+    // Cost and time for a new edge
+    pair<int, int> draw(SplitMix64& rng) const {
+        int cost = int(rng.uniform(1, maxWeight));
+        return {cost, time(cost, rng)};
+    }
+};
+
+// How the vertices are joined:
+//
+//   grid       a square grid, each vertex joined to its right and lower
+//              neighbors (degree 4)
+//   road       a grid thinned like a street map: every row is a through
+//              street, 60% of the vertical links and 10% of the cells'
+//              diagonals exist, and every 16th row and column is a highway
+//              whose edges take a third of the time (degree about 3.4)
+//   geometric  points uniform in the unit square, joined when closer than
+//              the radius that gives the average degree; costs grow with
+//              the distance (Penrose, Random Geometric Graphs, 2003)
+//   powerlaw   Chung-Lu graph whose expected degrees follow a power law
+//              with the given exponent (Chung and Lu, PNAS 2002), drawn in
+//              O(n + m) by skipping ahead geometrically (Miller and
+//              Hagberg, WAW 2011)
+enum class Topology { Grid, Road, Geometric, PowerLaw };
+
+inline bool parseTopology(const string& name, Topology& topology) {
+    const pair<const char*, Topology> names[] = {{"grid", Topology::Grid}, {"road", Topology::Road},
+                                                 {"geometric", Topology::Geometric},
+                                                 {"powerlaw", Topology::PowerLaw}};
+    for (const auto& [n, t] : names) {
+        if (name == n) {
+            topology = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+// What to generate. edges is a target: the vertex count is picked so the
+// expected edge count matches it, and the graph has about that many.
+struct GraphSpec {
+    Topology topology = Topology::Grid;
+    int64_t edges = 10000;
+    double degree = 0;      // average degree for geometric and powerlaw; 0 picks 8
+    double exponent = 2.5;  // powerlaw degree exponent, above 2
+    WeightModel weights;
+    uint64_t seed = 1;
+};
+
+class GraphGenerator {
+private:
+    static constexpr double ROAD_VERTICAL = 0.6;
+    static constexpr double ROAD_DIAGONAL = 0.1;
+    static constexpr int64_t HIGHWAY_SPACING = 16;
+
+    GraphSpec spec;
+    int64_t n = 0;
+    int64_t side = 0; // grid and road
+
+    // geometric: points sorted by cell (row-major), so neighbors in the
+    // plane get nearby ids; cellStart[c] is the first point of cell c
+    double radius = 0;
+    int64_t cells = 0; // per side
+    vector<float> px, py;
+    vector<int64_t> cellStart;
+
+    // powerlaw: vertex i's expected degree is weightScale * (i + 1)^-beta,
+    // non-increasing in i; weightSum is their sum. They are computed as
+    // needed: the skips land all over the vertex range, where a table of
+    // them would miss the cache on nearly every edge.
+    double beta = 0;
+    double weightScale = 0;
+    double weightSum = 0;
+
+    double weight(int64_t i) const {
+        return weightScale * pow(double(i + 1), -beta);
+    }
+
+    double degree() const {
+        return spec.degree > 0 ? spec.degree : 8;
+    }
+
+    int64_t cellOf(double x) const {
+        return min(cells - 1, int64_t(x * cells));
+    }
+
+    void placePoints() {
+        radius = sqrt(degree() / (numbers::pi * double(n)));
+        cells = max<int64_t>(1, int64_t(1 / radius));
+        vector<float> x(n), y(n);
+        cellStart.assign(cells * cells + 1, 0);
+        for (int64_t i = 0; i < n; ++i) {
+            SplitMix64 rng = itemRng(spec.seed ^ 0x5bd1e995, i);
+            x[i] = float(rng.unit());
+            y[i] = float(rng.unit());
+            ++cellStart[cellOf(y[i]) * cells + cellOf(x[i]) + 1];
+        }
+        for (int64_t c = 0; c < cells * cells; ++c) {
+            cellStart[c + 1] += cellStart[c];
+        }
+        px.resize(n);
+        py.resize(n);
+        vector<int64_t> next(cellStart.begin(), cellStart.end() - 1);
+        for (int64_t i = 0; i < n; ++i) {
+            int64_t at = next[cellOf(y[i]) * cells + cellOf(x[i])]++;
+            px[at] = x[i];
+            py[at] = y[i];
+        }
+    }
+
+    // Scales the weights to the average degree
+    void powerLawWeights() {
+        beta = 1 / (spec.exponent - 1);
+        double sum = 0;
+        for (int64_t i = 0; i < n; ++i) {
+            sum += pow(double(i + 1), -beta);
+        }
+        weightScale = degree() * double(n) / sum;
+        weightSum = degree() * double(n);
+    }
+
+    template<typename Emit>
+    void weighted(int64_t u, int64_t v, SplitMix64& rng, Emit&& emit) const {
+        auto [cost, time] = spec.weights.draw(rng);
+        emit(u, v, cost, time);
+    }
+
+    template<typename Emit>
+    void gridFrom(int64_t u, SplitMix64& rng, Emit&& emit) const {
+        int64_t r = u / side, c = u % side;
+        if (c + 1 < side) {
+            weighted(u, u + 1, rng, emit);
+        }
+        if (r + 1 < side) {
+            weighted(u, u + side, rng, emit);
+        }
+    }
+
+    template<typename Emit>
+    void roadFrom(int64_t u, SplitMix64& rng, Emit&& emit) const {
+        int64_t r = u / side, c = u % side;
+        auto street = [&](int64_t v, bool highway) {
+            auto [cost, time] = spec.weights.draw(rng);
+            emit(u, v, cost, highway ? max(1, time / 3) : time);
+        };
+        if (c + 1 < side) {
+            street(u + 1, r % HIGHWAY_SPACING == 0);
+        }
+        if (r + 1 < side && rng.unit() < ROAD_VERTICAL) {
+            street(u + side, c % HIGHWAY_SPACING == 0);
+        }
+        if (r + 1 < side && c + 1 < side && rng.unit() < ROAD_DIAGONAL) {
+            street(u + side + 1, false);
+        }
+    }
+
+    template<typename Emit>
+    void geometricFrom(int64_t u, SplitMix64& rng, Emit&& emit) const {
+        int64_t cx = cellOf(px[u]), cy = cellOf(py[u]);
+        double r2 = radius * radius;
+        for (int64_t y = max<int64_t>(0, cy - 1); y <= min(cells - 1, cy + 1); ++y) {
+            for (int64_t x = max<int64_t>(0, cx - 1); x <= min(cells - 1, cx + 1); ++x) {
+                int64_t cell = y * cells + x;
+                for (int64_t v = max(u + 1, cellStart[cell]); v < cellStart[cell + 1]; ++v) {
+                    double dx = px[v] - px[u], dy = py[v] - py[u];
+                    double d2 = dx * dx + dy * dy;
+                    if (d2 < r2) {
+                        int cost = 1 + int(sqrt(d2) / radius * (spec.weights.maxWeight - 1));
+                        emit(u, v, cost, spec.weights.time(cost, rng));
+                    }
+                }
+            }
+        }
+    }
+
+    // Each later vertex v joins u with probability min(w_u w_v / S, 1);
+    // weights do not increase with v, so runs of misses are skipped by
+    // drawing their length from the geometric distribution of the current
+    // probability and correcting with a rejection step.
+    template<typename Emit>
+    void powerLawFrom(int64_t u, SplitMix64& rng, Emit&& emit) const {
+        double wu = weight(u) / weightSum;
+        int64_t v = u + 1;
+        double p = v < n ? min(wu * weight(v), 1.0) : 0;
+        while (v < n && p > 0) {
+            if (p < 1) {
+                double r = rng.unit();
+                v += int64_t(floor(log(1 - r) / log(1 - p)));
+            }
+            if (v >= n) {
+                break;
+            }
+            double q = min(wu * weight(v), 1.0);
+            if (rng.unit() < q / p) {
+                weighted(u, v, rng, emit);
+            }
+            p = q;
+            ++v;
+        }
+    }
+
+public:
+    explicit GraphGenerator(const GraphSpec& s) : spec(s) {
+        if (spec.edges < 1 || spec.weights.maxWeight < 1) {
+            throw invalid_argument("graphgen: edges and maxWeight must be positive");
+        }
+        switch (spec.topology) {
+        case Topology::Grid:
+            side = max<int64_t>(2, llround(sqrt(double(spec.edges) / 2)));
+            n = side * side;
+            break;
+        case Topology::Road:
+            side = max<int64_t>(2, llround(sqrt(double(spec.edges) / (1 + ROAD_VERTICAL + ROAD_DIAGONAL))));
+            n = side * side;
+            break;
+        case Topology::Geometric:
+            n = max<int64_t>(2, llround(2 * double(spec.edges) / degree()));
+            placePoints();
+            break;
+        case Topology::PowerLaw:
+            if (!(spec.exponent > 2)) {
+                throw invalid_argument("graphgen: the power-law exponent must be above 2");
+            }
+            n = max<int64_t>(2, llround(2 * double(spec.edges) / degree()));
+            powerLawWeights();
+            break;
+        }
+        if (n > INT32_MAX) {
+            throw invalid_argument("graphgen: too many vertices for int ids");
+        }
+    }
+
+    int64_t numVertices() const {
+        return n;
+    }
+
+    // Calls emit(u, v, cost, time) for each edge u owns
+    template<typename Emit>
+    void edgesFrom(int64_t u, Emit&& emit) const {
+        SplitMix64 rng = itemRng(spec.seed, u);
+        switch (spec.topology) {
+        case Topology::Grid:
+            gridFrom(u, rng, emit);
+            break;
+        case Topology::Road:
+            roadFrom(u, rng, emit);
+            break;
+        case Topology::Geometric:
+            geometricFrom(u, rng, emit);
+            break;
+        case Topology::PowerLaw:
+            powerLawFrom(u, rng, emit);
+            break;
+        }
+    }
+
+    // Every edge, as an edge source for graph::loadFrozen()
+    template<typename Emit>
+    void forEachEdge(Emit&& emit) const {
+        for (int64_t u = 0; u < n; ++u) {
+            edgesFrom(u, emit);
+        }
+    }
+};
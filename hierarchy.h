@@ -0,0 +1,834 @@
+#pragma once
+
+#include "graph.h"
+#include "mapped_file.h"
+#include "pareto.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// Bicriteria contraction hierarchy: a one-off preprocessing of a static
+// graph after which a constrained query only searches a small part of it.
+//
+// Vertices are contracted one at a time, cheapest first. Contracting v
+// removes it from the remaining graph; for every pair of its remaining
+// neighbors (u, w), each (cost, time) combination of a u-v and a v-w edge
+// becomes a u-w shortcut unless a witness search from u that avoids v
+// finds a path at least as good in both criteria. A vertex pair keeps a
+// Pareto set ("bag") of parallel edges rather than one edge, so every
+// non-dominated way between them survives the contraction.
+//
+// A vertex that still has more than maxCoreDegree edges when its turn
+// comes is not contracted; it joins the core, which ranks above every
+// contracted vertex. Bags grow quickly near the top of the hierarchy when
+// cost and time are weakly correlated, so this keeps the build bounded;
+// a larger core makes queries slower, never wrong.
+//
+// The query graph ("upward graph") holds, in the row of each contracted
+// vertex, its edges to the vertices still there when it was contracted,
+// and in the row of each core vertex, its edges to other core vertices.
+// Every s-d path of the original graph is matched, at equal or better
+// (cost, time), by one that climbs from s over upward edges, walks the
+// core and comes down to d. A query therefore runs a label-setting search
+// over the upward graph from each end (the graph is undirected, so the
+// same rows serve both) and joins the two frontiers at every vertex both
+// searches reached. The answers are exactly those of the full search.
+//
+// Each upward edge records the vertex a shortcut bypasses (or NO_MIDDLE
+// for an input edge), from which paths are unpacked to input edges.
+template<typename VertexT, typename WeightT>
+class ContractionHierarchy {
+public:
+    using Graph = graph<VertexT, WeightT>;
+    static constexpr VertexT NO_MIDDLE = numeric_limits<VertexT>::max();
+
+private:
+    Graph upward;
+    const VertexT* middles = nullptr; // per upward CSR edge
+    size_t numCore = 0;
+
+    // Index of an upward edge between a and b with exactly this weight,
+    // stored in either row, or SIZE_MAX
+    size_t findArc(const VertexT& a, const VertexT& b, const WeightT& cost, const WeightT& time) const {
+        const auto& c = upward.csr();
+        for (VertexT row : {a, b}) {
+            VertexT other = row == a ? b : a;
+            for (uint64_t e = c.offsets[row]; e < c.offsets[row + 1]; ++e) {
+                if (c.targets[e] == other && c.costs[e] == cost && c.times[e] == time) {
+                    return e;
+                }
+            }
+        }
+        return SIZE_MAX;
+    }
+
+public:
+    // Takes over a finished upward graph; owner keeps view's arrays and
+    // middleArray alive.
+    void attach(const typename Graph::CSR& view, const VertexT* middleArray, size_t coreSize,
+                shared_ptr<const void> owner) {
+        upward.attachFrozen(view, move(owner));
+        middles = middleArray;
+        numCore = coreSize;
+    }
+
+    const Graph& upwardGraph() const {
+        return upward;
+    }
+
+    int NumVertices() const {
+        return upward.NumVertices();
+    }
+
+    size_t coreSize() const {
+        return numCore;
+    }
+
+    VertexT middle(size_t e) const {
+        return middles[e];
+    }
+
+    // Number of upward edges that are shortcuts rather than input edges
+    size_t numShortcuts() const {
+        size_t count = 0;
+        for (size_t e = 0; e < upward.csr().numEdges; ++e) {
+            count += middles[e] != NO_MIDDLE;
+        }
+        return count;
+    }
+
+    // Appends to path the input-graph vertices after a on the way to b
+    // along the upward edge a-b of the given weight (b last).
+    void unpack(const VertexT& a, const VertexT& b, const WeightT& cost, const WeightT& time,
+                vector<VertexT>& path) const {
+        size_t e = findArc(a, b, cost, time);
+        if (e == SIZE_MAX) {
+            throw runtime_error("hierarchy: no edge to unpack between " + to_string(a) + " and " +
+                                to_string(b));
+        }
+        VertexT m = middles[e];
+        if (m == NO_MIDDLE) {
+            path.push_back(b);
+            return;
+        }
+        // Both halves were fixed when m was contracted, so they sit in m's row
+        const auto& c = upward.csr();
+        for (uint64_t first = c.offsets[m]; first < c.offsets[m + 1]; ++first) {
+            if (c.targets[first] != a || c.costs[first] > cost || c.times[first] > time) {
+                continue;
+            }
+            WeightT restCost = cost - c.costs[first];
+            WeightT restTime = time - c.times[first];
+            if (findArc(m, b, restCost, restTime) != SIZE_MAX) {
+                unpack(a, m, c.costs[first], c.times[first], path);
+                unpack(m, b, restCost, restTime, path);
+                return;
+            }
+        }
+        throw runtime_error("hierarchy: shortcut " + to_string(a) + "-" + to_string(b) + " via " +
+                            to_string(m) + " has no halves");
+    }
+};
+
+// Knobs of buildHierarchy()
+struct HierarchyOptions {
+    // A vertex with more remaining edges than this (counting every entry
+    // of every bag) joins the core
+    size_t maxCoreDegree = 16;
+    // Labels one witness search may settle before giving up (giving up
+    // only adds shortcuts, never loses a path)
+    size_t witnessSettleLimit = 100;
+};
+
+// Contracts the input graph (see ContractionHierarchy). Kept separate from
+// the hierarchy itself: only the build needs the per-pair bags and the
+// witness-search workspace.
+template<typename VertexT, typename WeightT>
+class HierarchyBuilder {
+private:
+    using Hierarchy = ContractionHierarchy<VertexT, WeightT>;
+
+    struct Arc {
+        WeightT cost;
+        WeightT time;
+        VertexT middle;
+    };
+    using Bag = vector<Arc>; // cost ascending, time descending
+
+    struct Neighbor {
+        VertexT vertex;
+        Bag bag;
+    };
+
+    struct WitnessLabel {
+        WeightT cost;
+        WeightT time;
+        VertexT vertex;
+
+        // As a max-heap order: pops the least (cost, time) first
+        bool operator<(const WitnessLabel& other) const {
+            if (cost != other.cost) {
+                return cost > other.cost;
+            }
+            return time > other.time;
+        }
+    };
+
+    const HierarchyOptions options;
+    size_t n;
+    vector<vector<Neighbor>> adj; // remaining graph; final upward rows once contracted
+    vector<char> contracted;
+    vector<char> core;
+    vector<long> deletedNeighbors;
+
+    // Witness search workspace
+    vector<WeightT> tail;          // time of the last label settled at a vertex
+    vector<VertexT> touched;
+    vector<int> targetIndex;       // position in the current target list, or -1
+    vector<vector<pair<WeightT, WeightT>>> reached; // settled labels per target
+    vector<WitnessLabel> heap;     // abandoned searches leave it full, so clear() it
+
+    static bool dominated(const Bag& bag, const WeightT& cost, const WeightT& time) {
+        for (const Arc& arc : bag) {
+            if (arc.cost > cost) {
+                break;
+            }
+            if (arc.time <= time) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Adds arc to a Pareto bag unless something there is at least as good;
+    // drops what it dominates.
+    static bool insertArc(Bag& bag, const Arc& arc) {
+        if (dominated(bag, arc.cost, arc.time)) {
+            return false;
+        }
+        bag.erase(remove_if(bag.begin(), bag.end(),
+                            [&](const Arc& x) { return arc.cost <= x.cost && arc.time <= x.time; }),
+                  bag.end());
+        auto at = lower_bound(bag.begin(), bag.end(), arc,
+                              [](const Arc& x, const Arc& y) { return x.cost < y.cost; });
+        bag.insert(at, arc);
+        return true;
+    }
+
+    static Bag* bagTo(vector<Neighbor>& row, const VertexT& w) {
+        for (Neighbor& nb : row) {
+            if (nb.vertex == w) {
+                return &nb.bag;
+            }
+        }
+        return nullptr;
+    }
+
+    void addArc(const VertexT& u, const VertexT& w, const Arc& arc) {
+        Bag* bag = bagTo(adj[u], w);
+        if (bag == nullptr) {
+            adj[u].push_back(Neighbor{w, Bag()});
+            bag = &adj[u].back().bag;
+        }
+        insertArc(*bag, arc);
+    }
+
+    // Bicriteria search from u in the remaining graph without v, up to the
+    // given cost and time and the settle limit. Labels settled at the
+    // targets end up in reached[targetIndex[target]].
+    void witnessSearch(const VertexT& u, const VertexT& v, const WeightT& maxCost, const WeightT& maxTime) {
+        size_t settled = 0;
+        heap.push_back(WitnessLabel{0, 0, u});
+        while (!heap.empty() && settled < options.witnessSettleLimit) {
+            pop_heap(heap.begin(), heap.end());
+            WitnessLabel label = heap.back();
+            heap.pop_back();
+            if (tail[label.vertex] <= label.time) {
+                continue;
+            }
+            if (tail[label.vertex] == numeric_limits<WeightT>::max()) {
+                touched.push_back(label.vertex);
+            }
+            tail[label.vertex] = label.time;
+            ++settled;
+            if (targetIndex[label.vertex] >= 0) {
+                reached[targetIndex[label.vertex]].push_back({label.cost, label.time});
+            }
+            for (const Neighbor& nb : adj[label.vertex]) {
+                if (nb.vertex == v) {
+                    continue;
+                }
+                for (const Arc& arc : nb.bag) {
+                    if (!sumWithin(label.cost, arc.cost, maxCost)) {
+                        break;
+                    }
+                    if (sumWithin(label.time, arc.time, maxTime) && label.time + arc.time < tail[nb.vertex]) {
+                        heap.push_back(WitnessLabel{WeightT(label.cost + arc.cost), WeightT(label.time + arc.time),
+                                                    nb.vertex});
+                        push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+        }
+        heap.clear();
+        for (const VertexT& x : touched) {
+            tail[x] = numeric_limits<WeightT>::max();
+        }
+        touched.clear();
+    }
+
+    // Shortcut entries (counting both directions) that contracting v would
+    // add now; adds them as well unless simulate is set.
+    long contract(const VertexT& v, bool simulate) {
+        vector<Neighbor>& row = adj[v];
+        long added = 0;
+        vector<Bag> candidates;
+        for (size_t i = 0; i + 1 < row.size(); ++i) {
+            const VertexT u = row[i].vertex;
+
+            // Every non-dominated u-v-w combination, for each w after u
+            size_t numTargets = row.size() - i - 1;
+            candidates.assign(numTargets, Bag());
+            WeightT maxCost = 0;
+            WeightT maxTime = 0;
+            bool any = false;
+            for (size_t j = 0; j < numTargets; ++j) {
+                for (const Arc& in : row[i].bag) {
+                    for (const Arc& out : row[i + 1 + j].bag) {
+                        if (!sumWithin(in.cost, out.cost, numeric_limits<WeightT>::max()) ||
+                            !sumWithin(in.time, out.time, numeric_limits<WeightT>::max())) {
+                            continue; // no path through it has representable weights
+                        }
+                        Arc shortcut{WeightT(in.cost + out.cost), WeightT(in.time + out.time), v};
+                        if (insertArc(candidates[j], shortcut)) {
+                            maxCost = max(maxCost, shortcut.cost);
+                            maxTime = max(maxTime, shortcut.time);
+                            any = true;
+                        }
+                    }
+                }
+            }
+            if (!any) {
+                continue;
+            }
+
+            for (size_t j = 0; j < numTargets; ++j) {
+                targetIndex[row[i + 1 + j].vertex] = int(j);
+            }
+            reached.assign(numTargets, {});
+            witnessSearch(u, v, maxCost, maxTime);
+
+            for (size_t j = 0; j < numTargets; ++j) {
+                const VertexT w = row[i + 1 + j].vertex;
+                targetIndex[w] = -1;
+                for (const Arc& shortcut : candidates[j]) {
+                    bool witnessed = false;
+                    for (const auto& label : reached[j]) {
+                        if (label.first <= shortcut.cost && label.second <= shortcut.time) {
+                            witnessed = true;
+                            break;
+                        }
+                    }
+                    if (witnessed) {
+                        continue;
+                    }
+                    Bag* existing = bagTo(adj[u], w);
+                    if (existing != nullptr && dominated(*existing, shortcut.cost, shortcut.time)) {
+                        continue;
+                    }
+                    added += 2;
+                    if (!simulate) {
+                        addArc(u, w, shortcut);
+                        addArc(w, u, shortcut);
+                    }
+                }
+            }
+        }
+        return added;
+    }
+
+    // Contraction order key: edge difference plus contracted neighbors,
+    // which spreads contraction evenly over the graph
+    long priority(const VertexT& v) {
+        return contract(v, true) - 2 * long(arcCount(v)) + deletedNeighbors[v];
+    }
+
+    size_t arcCount(const VertexT& v) const {
+        size_t count = 0;
+        for (const Neighbor& nb : adj[v]) {
+            count += nb.bag.size();
+        }
+        return count;
+    }
+
+    void removeFromNeighbors(const VertexT& v) {
+        for (const Neighbor& nb : adj[v]) {
+            auto& other = adj[nb.vertex];
+            for (size_t k = 0; k < other.size(); ++k) {
+                if (other[k].vertex == v) {
+                    other[k] = move(other.back());
+                    other.pop_back();
+                    break;
+                }
+            }
+        }
+    }
+
+public:
+    HierarchyBuilder(const graph<VertexT, WeightT>& g, const HierarchyOptions& opts)
+        : options(opts), n(g.NumVertices()), adj(n), contracted(n, 0), core(n, 0), deletedNeighbors(n, 0),
+          tail(n, numeric_limits<WeightT>::max()), targetIndex(n, -1) {
+        for (size_t u = 0; u < n; ++u) {
+            for (const auto& edge : g.edges(VertexT(u))) {
+                if (edge.target != VertexT(u)) {
+                    addArc(VertexT(u), edge.target, Arc{edge.cost, edge.time, Hierarchy::NO_MIDDLE});
+                }
+            }
+        }
+    }
+
+    Hierarchy build() {
+        // Lazy priority queue: entries whose key is out of date are skipped
+        vector<long> current(n);
+        priority_queue<pair<long, VertexT>, vector<pair<long, VertexT>>, greater<pair<long, VertexT>>> order;
+        for (size_t v = 0; v < n; ++v) {
+            current[v] = priority(VertexT(v));
+            order.push({current[v], VertexT(v)});
+        }
+
+        while (!order.empty()) {
+            auto [key, v] = order.top();
+            order.pop();
+            if (contracted[v] || core[v] || key != current[v]) {
+                continue;
+            }
+            // Re-check a key that may have gone stale since it was queued
+            long fresh = priority(v);
+            if (fresh != key) {
+                current[v] = fresh;
+                if (!order.empty() && fresh > order.top().first) {
+                    order.push({fresh, v});
+                    continue;
+                }
+            }
+            if (arcCount(v) > options.maxCoreDegree) {
+                core[v] = 1;
+                continue;
+            }
+
+            contract(v, false);
+            contracted[v] = 1;
+            removeFromNeighbors(v);
+            for (const Neighbor& nb : adj[v]) {
+                if (!core[nb.vertex]) {
+                    ++deletedNeighbors[nb.vertex];
+                    current[nb.vertex] = priority(nb.vertex);
+                    order.push({current[nb.vertex], nb.vertex});
+                }
+            }
+        }
+
+        // Rows of contracted vertices are final; core rows hold the core
+        struct Arrays {
+            vector<uint64_t> offsets;
+            vector<VertexT> targets;
+            vector<WeightT> costs;
+            vector<WeightT> times;
+            vector<VertexT> middles;
+        };
+        auto arrays = make_shared<Arrays>();
+        arrays->offsets.assign(n + 1, 0);
+        size_t numCore = 0;
+        for (size_t v = 0; v < n; ++v) {
+            numCore += core[v];
+            for (const Neighbor& nb : adj[v]) {
+                for (const Arc& arc : nb.bag) {
+                    arrays->targets.push_back(nb.vertex);
+                    arrays->costs.push_back(arc.cost);
+                    arrays->times.push_back(arc.time);
+                    arrays->middles.push_back(arc.middle);
+                }
+            }
+            arrays->offsets[v + 1] = arrays->targets.size();
+        }
+
+        typename graph<VertexT, WeightT>::CSR view;
+        view.numVertices = n;
+        view.numEdges = arrays->targets.size();
+        view.offsets = arrays->offsets.data();
+        view.targets = arrays->targets.data();
+        view.costs = arrays->costs.data();
+        view.times = arrays->times.data();
+        Hierarchy hierarchy;
+        hierarchy.attach(view, arrays->middles.data(), numCore, arrays);
+        return hierarchy;
+    }
+};
+
+template<typename VertexT, typename WeightT>
+ContractionHierarchy<VertexT, WeightT> buildHierarchy(const graph<VertexT, WeightT>& g,
+                                                      const HierarchyOptions& options = HierarchyOptions()) {
+    return HierarchyBuilder<VertexT, WeightT>(g, options).build();
+}
+
+// Runs the upward search from each end, up to the budget, with no
+// pruning: each leaves its complete upward frontier behind.
+template<typename VertexT, typename WeightT>
+void hierarchySearch(const ContractionHierarchy<VertexT, WeightT>& ch,
+                     typename graph<VertexT, WeightT>::GraphAlgorithmState& forward,
+                     typename graph<VertexT, WeightT>::GraphAlgorithmState& backward,
+                     const VertexT& source, const VertexT& destination, const WeightT& budget) {
+    const VertexT nowhere = VertexT(ch.NumVertices());
+    labelSettingSearch(ch.upwardGraph(), forward, source, nowhere, budget, false);
+    labelSettingSearch(ch.upwardGraph(), backward, destination, nowhere, budget, false);
+}
+
+// Fastest in-budget path through the hierarchy. The two upward searches
+// take turns by the cheaper queue head, like bidirectionalParetoSearch().
+// A label that settles at a vertex the other side has reached is joined
+// with the fastest label there that still fits the budget; every pair is
+// tried when its later half settles. Once a joined path exists, labels no
+// faster than it are dropped on both sides. Ties on time go to the cheaper
+// path, as in the other engines. Use hierarchyPath() for the vertices.
+template<typename VertexT, typename WeightT>
+ConstrainedResult<WeightT> hierarchyParetoSearch(const ContractionHierarchy<VertexT, WeightT>& ch,
+                                                 typename graph<VertexT, WeightT>::GraphAlgorithmState& forward,
+                                                 typename graph<VertexT, WeightT>::GraphAlgorithmState& backward,
+                                                 const VertexT& source, const VertexT& destination,
+                                                 const WeightT& budget) {
+    using Graph = graph<VertexT, WeightT>;
+    using PathSignature = typename Graph::PathSignature;
+    using HeapElement = typename Graph::HeapElement;
+    using State = typename Graph::GraphAlgorithmState;
+
+    ConstrainedResult<WeightT> best;
+    if constexpr (is_signed<WeightT>::value) {
+        if (budget < 0) {
+            return best;
+        }
+    }
+    // Joined paths, like labels, stay within largestLabelWeight()
+    const WeightT costLimit = min(budget, largestLabelWeight<WeightT>());
+    forward.initialize(source);
+    backward.initialize(destination);
+    const Graph& up = ch.upwardGraph();
+
+    auto step = [&](State& self, State& other, bool isForward) {
+        HeapElement top = self.priorityQueue.top();
+        self.priorityQueue.pop();
+        const PathSignature& label = top.pathSignature;
+        if ((best.found && label.time > best.time) || self.frontierTail[top.vertex] <= label.time) {
+            return;
+        }
+        uint32_t id = self.appendPath(top.vertex, label, top.parent);
+
+        ConstrainedResult<WeightT> partner =
+            fastestWithinBudget(other.nonDominatedPaths[top.vertex], WeightT(costLimit - label.cost));
+        if (partner.found && sumWithin(label.time, partner.time, numeric_limits<WeightT>::max())) {
+            WeightT cost = label.cost + partner.cost;
+            WeightT time = label.time + partner.time;
+            if (!best.found || time < best.time || (time == best.time && cost < best.cost)) {
+                best.found = true;
+                best.cost = cost;
+                best.time = time;
+                best.forwardLabel = isForward ? id : partner.forwardLabel;
+                best.backwardLabel = isForward ? partner.forwardLabel : id;
+            }
+        }
+
+        for (const auto& edge : up.edges(top.vertex)) {
+            if (!sumWithin(label.cost, edge.cost, budget) ||
+                !sumWithin(label.time, edge.time, numeric_limits<WeightT>::max())) {
+                continue;
+            }
+            WeightT newCost = label.cost + edge.cost;
+            WeightT newTime = label.time + edge.time;
+            if ((best.found && newTime > best.time) ||
+                self.frontierTail[edge.target] <= newTime) {
+                continue;
+            }
+            self.priorityQueue.push(HeapElement(PathSignature(newCost, newTime), edge.target, id));
+        }
+    };
+
+    auto& fq = forward.priorityQueue;
+    auto& bq = backward.priorityQueue;
+    while (!fq.empty() || !bq.empty()) {
+        bool pickForward = bq.empty() ||
+                           (!fq.empty() && fq.top().pathSignature.cost <= bq.top().pathSignature.cost);
+        if (pickForward) {
+            step(forward, backward, true);
+        } else {
+            step(backward, forward, false);
+        }
+    }
+    return best;
+}
+
+// The destination's complete frontier up to maxBudget, cost ascending /
+// time descending, each entry naming its forward and backward label.
+template<typename VertexT, typename WeightT>
+vector<ConstrainedResult<WeightT>> hierarchyFrontier(const ContractionHierarchy<VertexT, WeightT>& ch,
+                                                     typename graph<VertexT, WeightT>::GraphAlgorithmState& forward,
+                                                     typename graph<VertexT, WeightT>::GraphAlgorithmState& backward,
+                                                     const VertexT& source, const VertexT& destination,
+                                                     const WeightT& maxBudget = numeric_limits<WeightT>::max()) {
+    hierarchySearch(ch, forward, backward, source, destination, maxBudget);
+    const WeightT costLimit = min(maxBudget, largestLabelWeight<WeightT>());
+    vector<ConstrainedResult<WeightT>> joined;
+    for (const VertexT& v : forward.touchedVertices) {
+        const auto& back = backward.nonDominatedPaths[v];
+        for (const auto& f : forward.nonDominatedPaths[v]) {
+            for (const auto& b : back) {
+                if (b.cost > costLimit - f.cost) {
+                    break;
+                }
+                if (!sumWithin(f.time, b.time, numeric_limits<WeightT>::max())) {
+                    continue;
+                }
+                ConstrainedResult<WeightT> r;
+                r.found = true;
+                r.cost = f.cost + b.cost;
+                r.time = f.time + b.time;
+                r.forwardLabel = f.label;
+                r.backwardLabel = b.label;
+                joined.push_back(r);
+            }
+        }
+    }
+    sort(joined.begin(), joined.end(), [](const auto& x, const auto& y) {
+        return x.cost < y.cost || (x.cost == y.cost && x.time < y.time);
+    });
+    vector<ConstrainedResult<WeightT>> frontier;
+    for (const auto& r : joined) {
+        if (frontier.empty() || r.time < frontier.back().time) {
+            frontier.push_back(r);
+        }
+    }
+    return frontier;
+}
+
+// Settled labels on the way to one label of a search, root first:
+// (vertex, cost, time) read back through the label pool and S[].
+template<typename State>
+auto labelTrail(const State& state, uint32_t label) {
+    using Entry = typename decay_t<decltype(state.nonDominatedPaths[0])>::value_type;
+    vector<pair<decltype(state.labels[0].vertex), Entry>> trail;
+    for (; label != NO_LABEL; label = state.labels[label].parent) {
+        auto v = state.labels[label].vertex;
+        for (const auto& entry : state.nonDominatedPaths[v]) {
+            if (entry.label == label) {
+                trail.push_back({v, entry});
+                break;
+            }
+        }
+    }
+    reverse(trail.begin(), trail.end());
+    return trail;
+}
+
+// Input-graph vertices of a hierarchy result, source first
+template<typename VertexT, typename WeightT>
+vector<VertexT> hierarchyPath(const ContractionHierarchy<VertexT, WeightT>& ch,
+                              const typename graph<VertexT, WeightT>::GraphAlgorithmState& forward,
+                              const typename graph<VertexT, WeightT>::GraphAlgorithmState& backward,
+                              const ConstrainedResult<WeightT>& result) {
+    vector<VertexT> path;
+    if (!result.found) {
+        return path;
+    }
+    auto up = labelTrail(forward, result.forwardLabel);
+    path.push_back(up[0].first);
+    for (size_t i = 1; i < up.size(); ++i) {
+        ch.unpack(up[i - 1].first, up[i].first, up[i].second.cost - up[i - 1].second.cost,
+                  up[i].second.time - up[i - 1].second.time, path);
+    }
+    // The backward trail runs from the destination up to the meeting vertex
+    auto down = labelTrail(backward, result.backwardLabel);
+    for (size_t i = down.size() - 1; i > 0; --i) {
+        ch.unpack(down[i].first, down[i - 1].first, down[i].second.cost - down[i - 1].second.cost,
+                  down[i].second.time - down[i - 1].second.time, path);
+    }
+    return path;
+}
+
+// Hierarchy file: the upward graph's CSR arrays plus the middle vertex of
+// every upward edge, laid out like a snapshot (see snapshot.h) so it is
+// mmap'ed back with no parsing.
+//
+//     HierarchyHeader
+//     offsets[numVertices + 1]   uint64_t
+//     targets[numEdges]          VertexT
+//     costs[numEdges]            WeightT
+//     times[numEdges]            WeightT
+//     middles[numEdges]          VertexT
+
+const char HIERARCHY_MAGIC[8] = {'C', 'P', 'A', 'T', 'H', 'C', 'H', 'Y'};
+const uint32_t HIERARCHY_VERSION = 1;
+
+struct HierarchyHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint32_t vertexBytes;
+    uint32_t weightBytes;
+    uint32_t weightSigned;
+    uint32_t reserved;
+    uint64_t numVertices;
+    uint64_t numEdges;
+    uint64_t coreSize;
+    uint64_t offsetsPos;
+    uint64_t targetsPos;
+    uint64_t costsPos;
+    uint64_t timesPos;
+    uint64_t middlesPos;
+    uint64_t fileSize;
+    uint64_t arraysChecksum; // over all five arrays, in file order
+    uint64_t headerChecksum; // over every field above
+};
+
+inline bool isHierarchy(const char* data, size_t size) {
+    return size >= sizeof(HIERARCHY_MAGIC) && memcmp(data, HIERARCHY_MAGIC, sizeof(HIERARCHY_MAGIC)) == 0;
+}
+
+inline uint64_t hierarchyChecksum(const char* base, const HierarchyHeader& header) {
+    uint64_t edges = header.numEdges;
+    uint64_t hash = snapshotChecksum(base + header.offsetsPos, (header.numVertices + 1) * sizeof(uint64_t));
+    hash ^= snapshotChecksum(base + header.targetsPos, edges * header.vertexBytes) * 3;
+    hash ^= snapshotChecksum(base + header.costsPos, edges * header.weightBytes) * 5;
+    hash ^= snapshotChecksum(base + header.timesPos, edges * header.weightBytes) * 7;
+    hash ^= snapshotChecksum(base + header.middlesPos, edges * header.vertexBytes) * 11;
+    return hash;
+}
+
+// Writes a hierarchy file. Returns false (with a message on cerr) if the
+// file cannot be written.
+template<typename VertexT, typename WeightT>
+bool writeHierarchy(const string& filename, const ContractionHierarchy<VertexT, WeightT>& ch) {
+    const auto& csr = ch.upwardGraph().csr();
+    size_t offsetsBytes = (csr.numVertices + 1) * sizeof(uint64_t);
+    size_t targetsBytes = csr.numEdges * sizeof(VertexT);
+    size_t weightsBytes = csr.numEdges * sizeof(WeightT);
+
+    HierarchyHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HIERARCHY_MAGIC, sizeof(HIERARCHY_MAGIC));
+    header.version = HIERARCHY_VERSION;
+    header.endianTag = SNAPSHOT_ENDIAN_TAG;
+    header.vertexBytes = sizeof(VertexT);
+    header.weightBytes = sizeof(WeightT);
+    header.weightSigned = is_signed<WeightT>::value;
+    header.numVertices = csr.numVertices;
+    header.numEdges = csr.numEdges;
+    header.coreSize = ch.coreSize();
+    header.offsetsPos = snapshotAlign(sizeof(HierarchyHeader));
+    header.targetsPos = snapshotAlign(header.offsetsPos + offsetsBytes);
+    header.costsPos = snapshotAlign(header.targetsPos + targetsBytes);
+    header.timesPos = snapshotAlign(header.costsPos + weightsBytes);
+    header.middlesPos = snapshotAlign(header.timesPos + weightsBytes);
+    header.fileSize = header.middlesPos + targetsBytes;
+
+    // Lay the arrays out in memory exactly as in the file
+    vector<char> image(header.fileSize, 0);
+    memcpy(image.data() + header.offsetsPos, csr.offsets, offsetsBytes);
+    memcpy(image.data() + header.targetsPos, csr.targets, targetsBytes);
+    memcpy(image.data() + header.costsPos, csr.costs, weightsBytes);
+    memcpy(image.data() + header.timesPos, csr.times, weightsBytes);
+    for (size_t e = 0; e < csr.numEdges; ++e) {
+        VertexT m = ch.middle(e);
+        memcpy(image.data() + header.middlesPos + e * sizeof(VertexT), &m, sizeof(VertexT));
+    }
+    header.arraysChecksum = hierarchyChecksum(image.data(), header);
+    header.headerChecksum = snapshotChecksum(&header, offsetof(HierarchyHeader, headerChecksum));
+    memcpy(image.data(), &header, sizeof(header));
+
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Error: Unable to open hierarchy file " << filename << " for writing" << endl;
+        return false;
+    }
+    out.write(image.data(), image.size());
+    out.close();
+    if (!out) {
+        cerr << "Error: failed writing hierarchy file " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+// Maps a hierarchy file and attaches ch to it. The header is always
+// validated; the array checksum only when verifyArrays is set, since it
+// touches every page. Returns false with a message on cerr on mismatch.
+template<typename VertexT, typename WeightT>
+bool loadHierarchy(const string& filename, ContractionHierarchy<VertexT, WeightT>& ch,
+                   bool verifyArrays = false) {
+    auto file = make_shared<const MappedFile>(filename);
+    if (!file->isOpen()) {
+        cerr << "Error: Unable to open hierarchy file " << filename << endl;
+        return false;
+    }
+    if (!isHierarchy(file->data(), file->size())) {
+        cerr << "Error: " << filename << " is not a hierarchy file (see --write-hierarchy)" << endl;
+        return false;
+    }
+    auto fail = [&](const char* why) {
+        cerr << "Error: hierarchy " << filename << ": " << why << endl;
+        return false;
+    };
+    HierarchyHeader header;
+    if (file->size() < sizeof(header)) {
+        return fail("truncated header");
+    }
+    memcpy(&header, file->data(), sizeof(header));
+    if (header.version != HIERARCHY_VERSION) {
+        return fail("unsupported version");
+    }
+    if (header.endianTag != SNAPSHOT_ENDIAN_TAG) {
+        return fail("written on a machine with different byte order");
+    }
+    if (header.headerChecksum != snapshotChecksum(&header, offsetof(HierarchyHeader, headerChecksum))) {
+        return fail("header checksum mismatch");
+    }
+    if (header.vertexBytes != sizeof(VertexT) || header.weightBytes != sizeof(WeightT) ||
+        header.weightSigned != uint32_t(is_signed<WeightT>::value)) {
+        return fail("vertex/weight types do not match this build");
+    }
+    size_t offsetsBytes = (header.numVertices + 1) * sizeof(uint64_t);
+    size_t targetsBytes = header.numEdges * sizeof(VertexT);
+    size_t weightsBytes = header.numEdges * sizeof(WeightT);
+    if (header.fileSize != file->size() || header.middlesPos + targetsBytes != header.fileSize ||
+        header.offsetsPos + offsetsBytes > header.targetsPos ||
+        header.targetsPos + targetsBytes > header.costsPos ||
+        header.costsPos + weightsBytes > header.timesPos ||
+        header.timesPos + weightsBytes > header.middlesPos) {
+        return fail("truncated or inconsistent layout");
+    }
+    const char* base = file->data();
+    if (verifyArrays && header.arraysChecksum != hierarchyChecksum(base, header)) {
+        return fail("array checksum mismatch");
+    }
+
+    typename graph<VertexT, WeightT>::CSR view;
+    view.numVertices = header.numVertices;
+    view.numEdges = header.numEdges;
+    view.offsets = reinterpret_cast<const uint64_t*>(base + header.offsetsPos);
+    view.targets = reinterpret_cast<const VertexT*>(base + header.targetsPos);
+    view.costs = reinterpret_cast<const WeightT*>(base + header.costsPos);
+    view.times = reinterpret_cast<const WeightT*>(base + header.timesPos);
+    file->adviseRandomAccess();
+    ch.attach(view, reinterpret_cast<const VertexT*>(base + header.middlesPos), header.coreSize, file);
+    return true;
+}
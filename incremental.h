@@ -0,0 +1,294 @@
+#pragma once
+
+#include "graph.h"
+#include "pareto.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// The Pareto frontier of every vertex from one source, up to a budget cap,
+// kept valid across edge updates (see graph::updateEdge()). build() runs
+// the plain label-setting sweep once; after edges change, repair() fixes
+// only what the change reaches, and query() answers any destination and
+// budget up to the cap from the frontiers by binary search.
+//
+// Each settled label links to its children (the labels extended from it),
+// and every label in S[v] has all its ancestors in S too. repair() then:
+//
+//   1. removes every label that crossed a changed edge, with its subtree,
+//      and marks the vertices that lost labels dirty;
+//   2. seeds candidates: the labels of each dirty vertex's neighbors
+//      extended into it, and the labels at a changed edge's ends extended
+//      across it (the edge may have got better);
+//   3. settles candidates in cost order, label-correcting: a candidate
+//      is kept unless S[v] dominates it, the labels it dominates leave S[v]
+//      with their subtrees (its own extensions will dominate those), and
+//      each kept label is extended to its neighbors.
+//
+// Afterwards every extension within the cap of every label in S is again
+// dominated at the neighbor, which is what makes the frontiers exact. The
+// work grows with the labels removed and added, not with the graph.
+//
+// Removed labels stay in the pool; once they outnumber the live ones,
+// repair() rebuilds from scratch instead.
+template<typename VertexT, typename WeightT>
+class IncrementalFrontier {
+public:
+    struct RepairStats {
+        size_t removed = 0; // labels taken out of S
+        size_t added = 0;   // labels settled by the repair
+        bool rebuilt = false;
+    };
+
+private:
+    using Graph = graph<VertexT, WeightT>;
+    using PathSignature = typename Graph::PathSignature;
+    using SettledPath = typename Graph::SettledPath;
+    using HeapElement = typename Graph::HeapElement;
+
+    typename Graph::GraphAlgorithmState state;
+    vector<uint32_t> firstChild;  // per label
+    vector<uint32_t> nextSibling; // per label
+    vector<char> live;            // per label: still in S
+    size_t liveLabels = 0;
+    vector<char> dirty;           // per vertex
+    vector<VertexT> dirtyVertices;
+    VertexT root{};
+    WeightT cap{};
+    bool ready = false;
+    RepairStats stats;
+
+    void link(uint32_t id) {
+        uint32_t parent = state.labels[id].parent;
+        if (parent != NO_LABEL) {
+            nextSibling[id] = firstChild[parent];
+            firstChild[parent] = id;
+        }
+    }
+
+    // Empty S[v] goes back to max(), the same out-of-band marker the
+    // searches start from; loaded weights and sums never reach it.
+    void refreshTail(const VertexT& v) {
+        const auto& paths = state.nonDominatedPaths[v];
+        state.frontierTail[v] = paths.empty() ? numeric_limits<WeightT>::max() : paths.back().time;
+    }
+
+    // Takes the label and everything extended from it out of S. The
+    // vertices that lose labels are marked dirty when markDirty is set.
+    void removeSubtree(uint32_t id, bool markDirty) {
+        vector<uint32_t> stack{id};
+        while (!stack.empty()) {
+            uint32_t label = stack.back();
+            stack.pop_back();
+            if (!live[label]) {
+                continue; // its subtree went with it
+            }
+            live[label] = 0;
+            --liveLabels;
+            ++stats.removed;
+            VertexT v = state.labels[label].vertex;
+            auto& paths = state.nonDominatedPaths[v];
+            auto it = find_if(paths.begin(), paths.end(), [&](const SettledPath& p) { return p.label == label; });
+            if (it != paths.end()) {
+                paths.erase(it);
+                refreshTail(v);
+            }
+            if (markDirty && !dirty[v]) {
+                dirty[v] = 1;
+                dirtyVertices.push_back(v);
+            }
+            for (uint32_t child = firstChild[label]; child != NO_LABEL; child = nextSibling[child]) {
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // Whether S[v] has a label no more expensive and no slower than ps
+    bool dominated(const VertexT& v, const PathSignature& ps) const {
+        const auto& paths = state.nonDominatedPaths[v];
+        auto after = upper_bound(paths.begin(), paths.end(), ps.cost,
+                                 [](const WeightT& cost, const SettledPath& p) { return cost < p.cost; });
+        return after != paths.begin() && prev(after)->time <= ps.time;
+    }
+
+    // Whether p extended by edge stays within the cap, with a time the
+    // weight type can hold
+    template<typename Edge>
+    bool extends(const PathSignature& p, const Edge& edge) const {
+        return sumWithin(p.cost, edge.cost, cap) && sumWithin(p.time, edge.time, numeric_limits<WeightT>::max());
+    }
+
+    void push(const Graph& g, const VertexT& from, const SettledPath& label) {
+        for (const auto& edge : g.edges(from)) {
+            if (!extends(label, edge)) {
+                continue;
+            }
+            PathSignature next(label.cost + edge.cost, label.time + edge.time);
+            if (!dominated(edge.target, next)) {
+                state.priorityQueue.push(HeapElement(next, edge.target, label.label));
+            }
+        }
+    }
+
+    // Step 3: settles queued candidates until none is left
+    void settle(const Graph& g) {
+        auto& pq = state.priorityQueue;
+        while (!pq.empty()) {
+            HeapElement top = pq.top();
+            pq.pop();
+            const VertexT v = top.vertex;
+            const PathSignature& ps = top.pathSignature;
+            if ((top.parent != NO_LABEL && !live[top.parent]) || dominated(v, ps)) {
+                continue;
+            }
+            auto& paths = state.nonDominatedPaths[v];
+            if (paths.empty()) {
+                state.touchedVertices.push_back(v);
+            }
+            // S[v] is cost ascending / time descending, so the labels ps
+            // dominates are the run from the first one costing as much
+            auto first = lower_bound(paths.begin(), paths.end(), ps.cost,
+                                     [](const SettledPath& p, const WeightT& cost) { return p.cost < cost; });
+            auto last = first;
+            while (last != paths.end() && last->time >= ps.time) {
+                ++last;
+            }
+            vector<uint32_t> beaten;
+            for (auto it = first; it != last; ++it) {
+                beaten.push_back(it->label);
+            }
+            size_t at = first - paths.begin();
+            paths.erase(first, last);
+            uint32_t id = state.labels.add(v, top.parent);
+            firstChild.push_back(NO_LABEL);
+            nextSibling.push_back(NO_LABEL);
+            live.push_back(1);
+            ++liveLabels;
+            ++stats.added;
+            link(id);
+            paths.insert(paths.begin() + at, SettledPath(ps, id));
+            refreshTail(v);
+            for (uint32_t label : beaten) {
+                removeSubtree(label, false);
+            }
+            push(g, v, paths[at]);
+        }
+    }
+
+public:
+    IncrementalFrontier(int numVertices = 0) : state(numVertices), dirty(numVertices, 0) {}
+
+    // Computes the frontiers from source from scratch, up to budgetCap
+    void build(const Graph& g, const VertexT& source, const WeightT& budgetCap) {
+        const VertexT nowhere = VertexT(g.NumVertices());
+        labelSettingSearch(g, state, source, nowhere, budgetCap, false);
+        size_t n = state.labels.size();
+        firstChild.assign(n, NO_LABEL);
+        nextSibling.assign(n, NO_LABEL);
+        live.assign(n, 1);
+        for (uint32_t id = 0; id < n; ++id) {
+            link(id);
+        }
+        liveLabels = n;
+        root = source;
+        cap = budgetCap;
+        ready = true;
+    }
+
+    // Whether query(destination, budget) may be asked for this source
+    bool covers(const VertexT& source, const WeightT& budget) const {
+        return ready && source == root && !(cap < budget);
+    }
+
+    // Brings the frontiers up to date with g after the edges between the
+    // given vertex pairs changed (in either direction).
+    void repair(const Graph& g, const vector<pair<VertexT, VertexT>>& changed) {
+        stats = RepairStats();
+        if (!ready || changed.empty()) {
+            return;
+        }
+        if (state.labels.size() > 2 * liveLabels) {
+            build(g, root, cap);
+            stats.rebuilt = true;
+            return;
+        }
+
+        // 1. Labels that crossed a changed edge, and their subtrees
+        vector<uint32_t> stale;
+        for (const auto& [a, b] : changed) {
+            for (const auto& [from, to] : {pair<VertexT, VertexT>(a, b), pair<VertexT, VertexT>(b, a)}) {
+                for (const SettledPath& p : state.nonDominatedPaths[to]) {
+                    uint32_t parent = state.labels[p.label].parent;
+                    if (parent != NO_LABEL && state.labels[parent].vertex == from) {
+                        stale.push_back(p.label);
+                    }
+                }
+            }
+        }
+        for (uint32_t label : stale) {
+            removeSubtree(label, true);
+        }
+
+        // 2. Candidates into the dirty vertices and across changed edges
+        for (const VertexT& v : dirtyVertices) {
+            for (const auto& edge : g.edges(v)) {
+                for (const SettledPath& p : state.nonDominatedPaths[edge.target]) {
+                    if (!extends(p, edge)) {
+                        continue;
+                    }
+                    PathSignature next(p.cost + edge.cost, p.time + edge.time);
+                    if (!dominated(v, next)) {
+                        state.priorityQueue.push(HeapElement(next, v, p.label));
+                    }
+                }
+            }
+        }
+        for (const auto& [a, b] : changed) {
+            for (const auto& [from, to] : {pair<VertexT, VertexT>(a, b), pair<VertexT, VertexT>(b, a)}) {
+                for (const auto& edge : g.edges(from)) {
+                    if (edge.target != to) {
+                        continue;
+                    }
+                    for (const SettledPath& p : state.nonDominatedPaths[from]) {
+                        if (!extends(p, edge)) {
+                            continue;
+                        }
+                        PathSignature next(p.cost + edge.cost, p.time + edge.time);
+                        if (!dominated(to, next)) {
+                            state.priorityQueue.push(HeapElement(next, to, p.label));
+                        }
+                    }
+                }
+            }
+        }
+        for (const VertexT& v : dirtyVertices) {
+            dirty[v] = 0;
+        }
+        dirtyVertices.clear();
+
+        // 3. Label-correcting settle
+        settle(g);
+    }
+
+    // Fastest path to destination within budget (at most the cap); its path
+    // reads back with pathTo(result.forwardLabel)
+    ConstrainedResult<WeightT> query(const VertexT& destination, const WeightT& budget) const {
+        return fastestWithinBudget(state.nonDominatedPaths[destination], budget);
+    }
+
+    vector<VertexT> pathTo(uint32_t label) const {
+        return state.pathTo(label);
+    }
+
+    // What the last repair() did
+    const RepairStats& lastRepair() const {
+        return stats;
+    }
+
+    size_t labelCount() const {
+        return liveLabels;
+    }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Index of "no label": the parent of a search's root label, and what a
+// result carries when it has no path.
+const uint32_t NO_LABEL = UINT32_MAX;
+
+// Bump allocator for the labels one search settles. Each label records its
+// vertex and the 32-bit index of the label it was extended from, so the
+// path behind any settled label is read back by following parent indices
+// to the root.
+//
+// Labels live in fixed-size chunks that are never moved, so growing the
+// pool copies nothing and an index stays valid for the whole search.
+// clear() releases every label at once; the chunks are kept and reused by
+// the next search.
+template<typename VertexT>
+class LabelPool {
+public:
+    struct Label {
+        VertexT vertex;
+        uint32_t parent;
+    };
+
+private:
+    static const size_t CHUNK_BITS = 16;
+    static const size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+
+    vector<unique_ptr<Label[]>> chunks;
+    size_t count = 0;
+
+public:
+    void clear() {
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // Stores a label and returns its index.
+    uint32_t add(const VertexT& vertex, uint32_t parent) {
+        if (count == NO_LABEL) {
+            throw length_error("label pool is limited to 2^32 - 1 labels per search");
+        }
+        size_t chunk = count >> CHUNK_BITS;
+        if (chunk == chunks.size()) {
+            chunks.emplace_back(new Label[CHUNK_SIZE]);
+        }
+        chunks[chunk][count & (CHUNK_SIZE - 1)] = Label{vertex, parent};
+        return uint32_t(count++);
+    }
+
+    // Reserves n consecutive labels, to be filled in with set(), and
+    // returns the first index. Lets several threads record the labels they
+    // settle without contending on add().
+    uint32_t extend(size_t n) {
+        if (n > size_t(NO_LABEL) - count) {
+            throw length_error("label pool is limited to 2^32 - 1 labels per search");
+        }
+        while (chunks.size() << CHUNK_BITS < count + n) {
+            chunks.emplace_back(new Label[CHUNK_SIZE]);
+        }
+        uint32_t first = uint32_t(count);
+        count += n;
+        return first;
+    }
+
+    void set(uint32_t id, const VertexT& vertex, uint32_t parent) {
+        chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)] = Label{vertex, parent};
+    }
+
+    const Label& operator[](uint32_t id) const {
+        return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+    }
+
+    // Vertices from the root label to the given one, root first.
+    vector<VertexT> path(uint32_t id) const {
+        vector<VertexT> vertices;
+        for (; id != NO_LABEL; id = (*this)[id].parent) {
+            vertices.push_back((*this)[id].vertex);
+        }
+        return vector<VertexT>(vertices.rbegin(), vertices.rend());
+    }
+};
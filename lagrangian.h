@@ -0,0 +1,232 @@
+#pragma once
+
+#include "graph.h"
+#include "pareto.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Lagrangian relaxation of the constrained query (LARAC, Juttner et al.,
+// INFOCOM 2001): a few single-criterion Dijkstra runs on the combined
+// weight time + lambda * cost that often settle the query outright and
+// otherwise bracket its answer for the exact search.
+//
+// For any lambda >= 0, the cheapest combined weight minus lambda * budget
+// is a lower bound on the fastest in-budget time, and a path that is
+// optimal for some lambda and fits the budget is an upper bound. LARAC
+// starts from the fastest path (lambda = 0; if it fits the budget it is
+// the answer) and the cheapest (lambda = infinity; if it does not fit,
+// nothing does), then sets lambda where the two cost the same, and keeps
+// whichever side the new optimum lands on, until lambda stops moving.
+//
+// The runs take the astar engine's lower bounds (see bounds.h): they stay
+// inside its cost ball, which holds every in-budget path, so the bounds
+// above still hold, and are A* searches guided by a * time bound + b * cost
+// bound, which is consistent for the combined weight a * time + b * cost.
+
+template<typename WeightT>
+struct LaracOutcome {
+    bool solved = false;             // result is the exact answer (or none)
+    ConstrainedResult<WeightT> result; // when solved; its path is in the state's label pool
+    TimeBracket<WeightT> bracket;    // when not solved
+    int runs = 0;                    // Dijkstra runs made
+};
+
+// Reusable workspace for the combined-weight Dijkstra runs; each run only
+// resets the entries the previous one wrote.
+template<typename VertexT, typename WeightT>
+class LagrangianSearch {
+private:
+    // One run's optimum: the combined weight and the path's own sums, kept
+    // wide since the path need not fit the budget (or the weight type)
+    struct Run {
+        bool found = false;
+        int64_t combined = 0;
+        int64_t cost = 0;
+        int64_t time = 0;
+        vector<VertexT> path; // source first
+    };
+
+    // Keys are (a * time + b * cost, tie). Ties go to the cheaper path, or
+    // to the faster one when minimizing cost alone, so lambda = 0 and
+    // lambda = infinity give the lexicographic fastest / cheapest paths.
+    // The queue holds keys plus the bounds' estimate of the rest.
+    using Key = pair<int64_t, int64_t>;
+    using QueueEntry = pair<Key, VertexT>;
+
+    vector<Key> dist;
+    vector<int64_t> costSum;
+    vector<int64_t> timeSum;
+    vector<VertexT> parent;
+    vector<VertexT> touched;
+    priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>> pq;
+
+    static constexpr int64_t UNREACHED = numeric_limits<int64_t>::max();
+
+    template<typename Bounds>
+    Run run(const graph<VertexT, WeightT>& g, const VertexT& source, const VertexT& destination,
+            const Bounds& bounds, int64_t a, int64_t b) {
+        for (const VertexT& v : touched) {
+            dist[v] = Key(UNREACHED, UNREACHED);
+        }
+        touched.clear();
+        while (!pq.empty()) {
+            pq.pop();
+        }
+        auto estimate = [&](const VertexT& v) {
+            return Key(a * bounds.time(v) + b * bounds.cost(v), a == 0 ? bounds.time(v) : bounds.cost(v));
+        };
+        auto plus = [](const Key& x, const Key& y) { return Key(x.first + y.first, x.second + y.second); };
+
+        dist[source] = Key(0, 0);
+        costSum[source] = 0;
+        timeSum[source] = 0;
+        parent[source] = source;
+        touched.push_back(source);
+        pq.push({estimate(source), source});
+        Run best;
+        while (!pq.empty()) {
+            VertexT v = pq.top().second;
+            Key key = pq.top().first;
+            pq.pop();
+            Key rest = estimate(v);
+            if (Key(key.first - rest.first, key.second - rest.second) > dist[v]) {
+                continue;
+            }
+            key = dist[v];
+            if (v == destination) {
+                best.found = true;
+                best.combined = key.first;
+                best.cost = costSum[v];
+                best.time = timeSum[v];
+                for (VertexT u = v;; u = parent[u]) {
+                    best.path.push_back(u);
+                    if (u == source) {
+                        break;
+                    }
+                }
+                reverse(best.path.begin(), best.path.end());
+                break;
+            }
+            for (const auto& edge : g.edges(v)) {
+                if (!bounds.reachable(edge.target)) {
+                    continue;
+                }
+                Key next(key.first + a * edge.time + b * edge.cost,
+                         key.second + (a == 0 ? edge.time : edge.cost));
+                if (next < dist[edge.target]) {
+                    if (dist[edge.target].first == UNREACHED) {
+                        touched.push_back(edge.target);
+                    }
+                    dist[edge.target] = next;
+                    costSum[edge.target] = costSum[v] + edge.cost;
+                    timeSum[edge.target] = timeSum[v] + edge.time;
+                    parent[edge.target] = v;
+                    pq.push({plus(next, estimate(edge.target)), edge.target});
+                }
+            }
+        }
+        return best;
+    }
+
+public:
+    // Gives up refining lambda after this many runs and brackets instead
+    static const int MAX_RUNS = 16;
+
+    LagrangianSearch(int numVertices = 0)
+        : dist(numVertices, Key(UNREACHED, UNREACHED)), costSum(numVertices), timeSum(numVertices),
+          parent(numVertices) {}
+
+    // Runs LARAC for one query, with bounds computed for its destination
+    // and budget. A solved outcome with a path leaves that
+    // path in state's label pool (state is reset), so resultPath() reads it
+    // back like a label search's answer; ties on time go to the cheaper
+    // path, as they do there. Otherwise the outcome brackets the fastest
+    // in-budget time between the Lagrangian bound and the best in-budget
+    // path found.
+    template<typename Bounds>
+    LaracOutcome<WeightT> solve(const graph<VertexT, WeightT>& g,
+                                typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+                                const VertexT& source, const VertexT& destination, const WeightT& budget,
+                                const Bounds& bounds) {
+        LaracOutcome<WeightT> outcome;
+        auto answer = [&](const Run& r) {
+            outcome.solved = true;
+            state.initialize(source);
+            state.priorityQueue.pop();
+            // A path too slow for a label is one the label searches
+            // cannot represent either: they report none
+            if (r.found && r.time <= int64_t(largestLabelWeight<WeightT>())) {
+                uint32_t id = NO_LABEL;
+                for (const VertexT& v : r.path) {
+                    id = state.labels.add(v, id);
+                }
+                outcome.result.found = true;
+                outcome.result.cost = WeightT(r.cost);
+                outcome.result.time = WeightT(r.time);
+                outcome.result.forwardLabel = id;
+            }
+            return outcome;
+        };
+
+        if (!bounds.reachable(source)) {
+            return answer(Run());
+        }
+        // What fits, as the label searches see it (see largestLabelWeight())
+        const int64_t costLimit = min<int64_t>(budget, largestLabelWeight<WeightT>());
+        Run fastest = run(g, source, destination, bounds, 1, 0);
+        outcome.runs = 1;
+        if (!fastest.found || fastest.cost <= costLimit) {
+            return answer(fastest);
+        }
+        Run cheapest = run(g, source, destination, bounds, 0, 1);
+        outcome.runs = 2;
+        if (cheapest.cost > costLimit) {
+            return answer(Run());
+        }
+
+        // fastest does not fit and cheapest does, and is slower. lambda =
+        // b / a makes them cost the same combined weight; the lower bound
+        // at lambda is (minimum of a * time + b * cost - b * budget) / a.
+        int64_t lower = 0;
+        while (outcome.runs < MAX_RUNS) {
+            int64_t a = int64_t(fastest.cost) - cheapest.cost;
+            int64_t b = int64_t(cheapest.time) - fastest.time;
+            int64_t common = gcd(a, b);
+            a /= common;
+            b /= common;
+            Run r = run(g, source, destination, bounds, a, b);
+            ++outcome.runs;
+            int64_t slack = r.combined - b * costLimit;
+            lower = max(lower, slack >= 0 ? (slack + a - 1) / a : -(-slack / a));
+            bool optimal = r.combined == a * int64_t(cheapest.time) + b * int64_t(cheapest.cost);
+            if (!optimal) {
+                if (r.cost <= costLimit) {
+                    cheapest = move(r);
+                } else {
+                    fastest = move(r);
+                }
+            }
+            // Once the incumbent is no slower than the bound itself (not
+            // just its ceiling), every in-budget path that fast has a
+            // combined weight of at least a * time + b * budget, so costs
+            // exactly the budget (b > 0): the incumbent is the answer, ties
+            // and all.
+            if (a * int64_t(cheapest.time) <= slack) {
+                return answer(cheapest);
+            }
+            if (optimal) {
+                break;
+            }
+        }
+        outcome.bracket.lower = WeightT(lower);
+        outcome.bracket.upper = WeightT(min<int64_t>(cheapest.time, numeric_limits<WeightT>::max()));
+        return outcome;
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Read-only view of a whole file. On POSIX systems the file is mmap'ed, so
+// the bytes come straight from the page cache with no copy; elsewhere the
+// file is read into a private buffer.
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    string buffer;
+#endif
+
+public:
+    explicit MappedFile(const string& filename) {
+#ifdef _WIN32
+        ifstream in(filename, ios::binary);
+        if (!in.is_open()) {
+            return;
+        }
+        buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        bytes = buffer.data();
+        length = buffer.size();
+        opened = true;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            return;
+        }
+        length = info.st_size;
+        if (length > 0) {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                length = 0;
+                return;
+            }
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(mapping);
+        }
+        // The mapping stays valid after the descriptor is closed.
+        close(fd);
+        opened = true;
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (bytes != nullptr) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Searches over a mapped snapshot jump around the file; drop the
+    // sequential read-ahead hint given at open time.
+    void adviseRandomAccess() const {
+#ifndef _WIN32
+        if (bytes != nullptr) {
+            madvise(const_cast<char*>(bytes), length, MADV_RANDOM);
+        }
+#endif
+    }
+
+    bool isOpen() const {
+        return opened;
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
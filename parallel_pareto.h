@@ -0,0 +1,391 @@
+#pragma once
+
+#include "bounds.h"
+#include "graph.h"
+#include "pareto.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <barrier>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <queue>
+#include <vector>
+
+using namespace std;
+
+// Edge facts that decide how many labels one round of the parallel search
+// may settle. Computed once per graph by labelWindow().
+template<typename WeightT>
+struct LabelWindow {
+    WeightT minPositiveCost = numeric_limits<WeightT>::max();
+    bool zeroCostEdges = false;
+};
+
+template<typename VertexT, typename WeightT>
+LabelWindow<WeightT> labelWindow(const graph<VertexT, WeightT>& g) {
+    const auto& c = g.csr();
+    LabelWindow<WeightT> window;
+    for (size_t e = 0; e < c.numEdges; ++e) {
+        if (c.costs[e] > 0) {
+            window.minPositiveCost = min(window.minPositiveCost, c.costs[e]);
+        } else {
+            window.zeroCostEdges = true;
+        }
+    }
+    return window;
+}
+
+// Multi-threaded version of labelSettingSearch(): settles the same labels,
+// so S[destination] ends up with the same frontier, but a whole round of
+// them at a time.
+//
+// Let c0 be the smallest queued cost. A label yet to be made extends some
+// queued label, so it either costs at least c0 + minPositiveCost or was
+// reached from a cost-c0 label over zero-cost edges only. Hence:
+//
+//   - with no zero-cost edges, every queued label costing less than
+//     c0 + minPositiveCost is final, and a round settles all of them;
+//   - otherwise a round settles cost level c0: the fastest cost-c0 label
+//     of each vertex, found by relaxing zero-cost edges from the queued
+//     cost-c0 labels until no time improves (Bellman-Ford on time over the
+//     zero-cost edges), then expanded over the positive-cost ones.
+//
+// The search runs on the threads of workers (see worker_pool.h), which
+// outlive it. Vertices are split among them by v % numThreads. Each thread
+// keeps the queued labels of its own vertices in its own heap, pops its
+// share of the round in (cost, time) order and runs the usual S[v]
+// dominance check with no locking. Label pool slots for the round are then
+// reserved in one step and every thread expands its settled labels,
+// writing the new labels into per-destination-thread buffers; at the end
+// of the round each thread merges the buffers addressed to it into its
+// heap. Barriers separate the phases, so S[], frontierTail and the pool
+// are only read while no one writes them.
+//
+// Labels are queued by their own (cost, time), in binary heaps or, with a
+// non-zero bucketSpan (see labelBucketSpan(), unbounded), bucket queues;
+// the bounds only prune, as they do in the sequential search. Destination
+// pruning uses the best destination time settled in earlier rounds.
+template<typename VertexT, typename WeightT, typename Bounds = NoBounds>
+void parallelLabelSettingSearch(const graph<VertexT, WeightT>& g,
+                                typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+                                const VertexT& source, const VertexT& destination,
+                                const WeightT& budget, bool pruneByDestination,
+                                const LabelWindow<WeightT>& window, WorkerPool& workers,
+                                const Bounds& bounds = Bounds(), size_t bucketSpan = 0) {
+    using Graph = graph<VertexT, WeightT>;
+    using PathSignature = typename Graph::PathSignature;
+    using HeapElement = typename Graph::HeapElement;
+    using SettledPath = typename Graph::SettledPath;
+    const WeightT INFINITE = numeric_limits<WeightT>::max();
+    const uint32_t NO_SLOT = numeric_limits<uint32_t>::max();
+
+    // Resets S[] and the label pool; the state's own queue is not used.
+    state.initialize(source);
+    state.priorityQueue.pop();
+    if (!bounds.reachable(source)) {
+        return;
+    }
+    const int numThreads = workers.size();
+
+    auto owner = [numThreads](const VertexT& v) {
+        return size_t(v) % size_t(numThreads);
+    };
+
+    // A label settled this round. Its parent is either a label of an
+    // earlier round or, when reached over a zero-cost edge within the
+    // round, this round's label at parentVertex.
+    struct Settled {
+        VertexT vertex;
+        PathSignature label;
+        uint32_t parent;
+        VertexT parentVertex;
+        bool parentInRound;
+        bool changed;   // needs its zero-cost edges relaxed
+        size_t slot;    // its position in S[vertex]
+    };
+    // A zero-cost edge relaxation sent to the target's owner
+    struct Relaxation {
+        VertexT vertex;
+        WeightT time;
+        VertexT from;
+    };
+
+    vector<vector<vector<HeapElement>>> outbox(numThreads, vector<vector<HeapElement>>(numThreads));
+    vector<vector<vector<Relaxation>>> relaxations(numThreads, vector<vector<Relaxation>>(numThreads));
+    vector<vector<Settled>> settled(numThreads);
+    vector<vector<VertexT>> touched(numThreads);
+    vector<PathSignature> heads(numThreads, PathSignature(INFINITE, INFINITE));
+    vector<char> headValid(numThreads, 0);
+    vector<char> changedAny(numThreads, 0);
+    vector<uint32_t> firstLabel(numThreads);
+    vector<uint32_t> roundSlot(window.zeroCostEdges ? g.NumVertices() : 0, NO_SLOT);
+    WeightT destinationTime = INFINITE; // written by the destination's owner
+    exception_ptr failure;
+    barrier sync(numThreads);
+
+    auto& S = state.nonDominatedPaths;
+    auto& tail = state.frontierTail;
+    const auto& csr = g.csr();
+
+    // Runs the search over one queue per thread
+    auto run = [&](auto& queues) {
+        queues[owner(source)].push(HeapElement(PathSignature(0, 0), source));
+
+        auto worker = [&](int t) {
+            auto& queue = queues[t];
+            auto& mine = settled[t];
+            vector<uint32_t> keep; // relaxFilter() output
+            WeightT bestTime = INFINITE;
+
+            // Dominated by a label settled in an earlier round, or unable to
+            // beat the best destination time
+            auto hopeless = [&](const VertexT& v, const WeightT& time) {
+                return !sumBelow(time, bounds.time(v), bestTime) || tail[v] <= time;
+            };
+            // Keeps the fastest cost-c0 candidate per vertex (zero-cost mode)
+            auto offer = [&](const VertexT& v, const PathSignature& label, uint32_t parent,
+                             const VertexT& parentVertex, bool parentInRound) {
+                uint32_t& slot = roundSlot[v];
+                if (slot == NO_SLOT) {
+                    slot = uint32_t(mine.size());
+                    mine.push_back(Settled{v, label, parent, parentVertex, parentInRound, true, 0});
+                } else if (label.time < mine[slot].label.time) {
+                    mine[slot] = Settled{v, label, parent, parentVertex, parentInRound, true, 0};
+                }
+            };
+            auto settle = [&](Settled& s) {
+                auto& Sv = S[s.vertex];
+                if (Sv.empty()) {
+                    touched[t].push_back(s.vertex);
+                }
+                Sv.push_back(SettledPath(s.label, NO_LABEL));
+                s.slot = Sv.size() - 1;
+                tail[s.vertex] = s.label.time;
+                if (s.vertex == destination && pruneByDestination) {
+                    bestTime = s.label.time;
+                    destinationTime = s.label.time;
+                }
+            };
+
+            while (true) {
+                headValid[t] = !queue.empty();
+                if (headValid[t]) {
+                    heads[t] = queue.top().pathSignature;
+                }
+                sync.arrive_and_wait();
+
+                bool any = false;
+                WeightT c0 = INFINITE;
+                for (int i = 0; i < numThreads; ++i) {
+                    if (headValid[i] && (!any || heads[i].cost < c0)) {
+                        c0 = heads[i].cost;
+                        any = true;
+                    }
+                }
+                if (!any) {
+                    break;
+                }
+                WeightT lastCost = c0;
+                if (!window.zeroCostEdges) {
+                    lastCost = c0 > INFINITE - (window.minPositiveCost - 1) ? INFINITE
+                                                                            : WeightT(c0 + (window.minPositiveCost - 1));
+                }
+
+                // This thread's share of the round, in (cost, time) order
+                mine.clear();
+                while (!queue.empty() && queue.top().pathSignature.cost <= lastCost) {
+                    HeapElement e = queue.top();
+                    queue.pop();
+                    if (hopeless(e.vertex, e.pathSignature.time)) {
+                        continue;
+                    }
+                    if (window.zeroCostEdges) {
+                        offer(e.vertex, e.pathSignature, e.parent, e.vertex, false);
+                    } else {
+                        mine.push_back(Settled{e.vertex, e.pathSignature, e.parent, e.vertex, false, false, 0});
+                        settle(mine.back());
+                    }
+                }
+
+                if (window.zeroCostEdges) {
+                    // Relax zero-cost edges until no cost-c0 time improves
+                    while (true) {
+                        for (Settled& s : mine) {
+                            if (!s.changed) {
+                                continue;
+                            }
+                            s.changed = false;
+                            if (s.vertex == destination) {
+                                continue;
+                            }
+                            for (const auto& edge : g.edges(s.vertex)) {
+                                if (edge.cost != 0 || !bounds.reachable(edge.target)) {
+                                    continue;
+                                }
+                                if (!sumWithin(c0, bounds.cost(edge.target), budget) ||
+                                    !sumWithin(s.label.time, edge.time, INFINITE)) {
+                                    continue;
+                                }
+                                WeightT newTime = s.label.time + edge.time;
+                                relaxations[t][owner(edge.target)].push_back(Relaxation{edge.target, newTime, s.vertex});
+                            }
+                        }
+                        sync.arrive_and_wait();
+
+                        bool improved = false;
+                        for (auto& from : relaxations) {
+                            for (const Relaxation& r : from[t]) {
+                                if (hopeless(r.vertex, r.time)) {
+                                    continue;
+                                }
+                                uint32_t slot = roundSlot[r.vertex];
+                                if (slot == NO_SLOT || r.time < mine[slot].label.time) {
+                                    offer(r.vertex, PathSignature(c0, r.time), NO_LABEL, r.from, true);
+                                    improved = true;
+                                }
+                            }
+                            from[t].clear();
+                        }
+                        changedAny[t] = improved;
+                        sync.arrive_and_wait();
+
+                        bool again = false;
+                        for (int i = 0; i < numThreads; ++i) {
+                            again = again || changedAny[i];
+                        }
+                        if (!again) {
+                            break;
+                        }
+                    }
+                    for (Settled& s : mine) {
+                        roundSlot[s.vertex] = NO_SLOT;
+                        settle(s);
+                    }
+                }
+                sync.arrive_and_wait();
+
+                if (t == 0) {
+                    size_t total = 0;
+                    for (const auto& list : settled) {
+                        total += list.size();
+                    }
+                    try {
+                        uint32_t next = state.labels.extend(total);
+                        for (int i = 0; i < numThreads; ++i) {
+                            firstLabel[i] = next;
+                            next += uint32_t(settled[i].size());
+                        }
+                    } catch (...) {
+                        failure = current_exception();
+                    }
+                }
+                sync.arrive_and_wait();
+                if (failure) {
+                    break;
+                }
+                for (size_t i = 0; i < mine.size(); ++i) {
+                    S[mine[i].vertex][mine[i].slot].label = firstLabel[t] + uint32_t(i);
+                }
+                if (window.zeroCostEdges) {
+                    // In-round parents are looked up in S below
+                    sync.arrive_and_wait();
+                }
+
+                bestTime = destinationTime;
+                bool done = pruneByDestination && bestTime <= bounds.time(source);
+                for (size_t i = 0; i < mine.size(); ++i) {
+                    const Settled& s = mine[i];
+                    uint32_t id = firstLabel[t] + uint32_t(i);
+                    uint32_t parent = s.parentInRound ? S[s.parentVertex].back().label : s.parent;
+                    state.labels.set(id, s.vertex, parent);
+                    if (done || s.vertex == destination) {
+                        continue;
+                    }
+
+                    // Same edge filter as the sequential search
+                    const uint64_t first = csr.offsets[s.vertex];
+                    const size_t degree = csr.offsets[s.vertex + 1] - first;
+                    if (keep.size() < degree) {
+                        keep.resize(degree);
+                    }
+                    size_t kept = relaxFilter(csr.targets + first, csr.costs + first, csr.times + first, degree,
+                                              s.label.cost, s.label.time, budget, bestTime, tail.data(),
+                                              keep.data());
+                    for (size_t k = 0; k < kept; ++k) {
+                        const size_t e = first + keep[k];
+                        const VertexT neighbor = csr.targets[e];
+                        if (!bounds.reachable(neighbor) || (window.zeroCostEdges && csr.costs[e] == 0)) {
+                            continue; // zero-cost edges were relaxed within the round
+                        }
+                        WeightT newCost = s.label.cost + csr.costs[e];
+                        WeightT newTime = s.label.time + csr.times[e];
+                        if (!sumWithin(newCost, bounds.cost(neighbor), budget) ||
+                            !sumBelow(newTime, bounds.time(neighbor), bestTime)) {
+                            continue;
+                        }
+                        outbox[t][owner(neighbor)].push_back(
+                            HeapElement(PathSignature(newCost, newTime), neighbor, id));
+                    }
+                }
+                sync.arrive_and_wait();
+                if (done) {
+                    break;
+                }
+
+                for (auto& from : outbox) {
+                    for (const HeapElement& e : from[t]) {
+                        queue.push(e);
+                    }
+                    from[t].clear();
+                }
+            }
+        };
+
+        workers.run(worker);
+    };
+
+    if (bucketSpan > 0) {
+        vector<BucketQueue<HeapElement>> queues(numThreads);
+        for (auto& queue : queues) {
+            queue.reset(bucketSpan);
+        }
+        run(queues);
+    } else {
+        vector<priority_queue<HeapElement>> queues(numThreads);
+        run(queues);
+    }
+
+    for (const auto& list : touched) {
+        state.touchedVertices.insert(state.touchedVertices.end(), list.begin(), list.end());
+    }
+    if (failure) {
+        rethrow_exception(failure);
+    }
+}
+
+// Parallel counterpart of paretoSearch()
+template<typename VertexT, typename WeightT, typename Bounds = NoBounds>
+ConstrainedResult<WeightT> parallelParetoSearch(const graph<VertexT, WeightT>& g,
+                                                typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+                                                const VertexT& source, const VertexT& destination,
+                                                const WeightT& budget, const LabelWindow<WeightT>& window,
+                                                WorkerPool& workers, const Bounds& bounds = Bounds(),
+                                                size_t bucketSpan = 0) {
+    parallelLabelSettingSearch(g, state, source, destination, budget, true, window, workers, bounds,
+                               bucketSpan);
+    return fastestWithinBudget(state.nonDominatedPaths[destination], budget);
+}
+
+// Parallel counterpart of paretoFrontier()
+template<typename VertexT, typename WeightT, typename Bounds = NoBounds>
+typename graph<VertexT, WeightT>::NonDominatedPathsSet
+parallelParetoFrontier(const graph<VertexT, WeightT>& g,
+                       typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+                       const VertexT& source, const VertexT& destination, const WeightT& maxBudget,
+                       const LabelWindow<WeightT>& window, WorkerPool& workers, const Bounds& bounds = Bounds(),
+                       size_t bucketSpan = 0) {
+    parallelLabelSettingSearch(g, state, source, destination, maxBudget, false, window, workers, bounds,
+                               bucketSpan);
+    return state.nonDominatedPaths[destination];
+}
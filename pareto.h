@@ -0,0 +1,596 @@
+#pragma once
+
+#include "bounds.h"
+#include "dominance.h"
+#include "graph.h"
+#include "relax_kernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// Answer to a single constrained query: the fastest path whose cost fits
+// within the budget. The path itself is held as label indices into the
+// search workspaces (see resultPath()): forwardLabel in the state searched
+// from the source and, for bidirectional results, backwardLabel in the one
+// searched from the destination. Either may be NO_LABEL. approximation is
+// 1 for exact searches; under EpsilonDominance the time is at most that
+// many times the fastest in-budget time (see dominance.h).
+template<typename WeightT>
+struct ConstrainedResult {
+    bool found = false;
+    WeightT cost = 0;
+    WeightT time = 0;
+    uint32_t forwardLabel = NO_LABEL;
+    uint32_t backwardLabel = NO_LABEL;
+    double approximation = 1;
+};
+
+// What is known about a query's answer before its label search: the
+// fastest in-budget time lies in [lower, upper], e.g. from a Lagrangian
+// bound and a path already found (see lagrangian.h). The defaults know
+// nothing.
+template<typename WeightT>
+struct TimeBracket {
+    WeightT lower = 0;
+    WeightT upper = numeric_limits<WeightT>::max();
+};
+
+// Exact multi-label (Pareto) label-setting search; the engine behind both
+// paretoSearch() and paretoFrontier().
+//
+// Labels are popped from the queue in non-decreasing cost (time breaks ties),
+// so every label appended to S[v] has a cost at least as large as the ones
+// already there. S[v] therefore stays in increasing cost / decreasing time
+// order and a popped label is dominated exactly when its time is no better
+// than S[v].back().time -- one comparison, no scan.
+//
+// Labels whose cost exceeds the budget are never pushed. With
+// pruneByDestination set, once a destination label is settled anything
+// that is not strictly faster than it is dropped as well: that keeps the
+// fastest in-budget answer exact but leaves only part of the destination's
+// frontier. Destination labels are never expanded either way, since leaving
+// and re-entering the destination can only cost more and take longer.
+//
+// bounds (see bounds.h) supplies lower bounds on the cost and time still
+// needed to reach the destination. The queue then holds each label keyed by
+// (cost + bounds.cost(v), time + bounds.time(v)) -- an A*-style order that
+// is still plain cost order among the labels of any one vertex, so the
+// S[v] invariant above holds. A label goes as soon as its cost key exceeds
+// the budget or its time key cannot beat the best destination time. With
+// NoBounds the keys are the labels themselves.
+//
+// Labels are queued either in the binary heap or, for small integer key
+// spreads, in a bucket queue (see labelBucketSpan()); the loop below is
+// the same for both.
+//
+// When this returns, state.nonDominatedPaths[destination] holds the
+// destination's frontier (cost ascending, time descending). Every settled
+// label is kept in state.labels with a link to the label it extends, so
+// the path of any frontier entry can be read back with state.pathTo().
+// dominance (see dominance.h) may stand a queued label for several paths:
+// keys and the frontier test then use its apex, while S[v] and bestTime
+// get the path it settles. With ExactDominance every label is its own
+// path. onSettled(v, path) runs right after each one is appended to S[v].
+// With pruneByDestination, a bracket on the answer's time starts bestTime
+// just above its upper end and stops the search once a destination label
+// reaches its lower end.
+// The graph must be frozen: edges(v) reads straight from the CSR arrays.
+template<typename VertexT, typename WeightT, typename Bounds, typename Queue, typename Dominance,
+         typename OnSettled>
+void labelSettingLoop(const graph<VertexT, WeightT>& g,
+                      typename graph<VertexT, WeightT>::GraphAlgorithmState& state, Queue& pq,
+                      const VertexT& source, const VertexT& destination,
+                      const WeightT& budget, bool pruneByDestination, const Bounds& bounds,
+                      Dominance& dominance, OnSettled& onSettled, const TimeBracket<WeightT>& bracket) {
+    using Graph = graph<VertexT, WeightT>;
+    using PathSignature = typename Graph::PathSignature;
+    using HeapElement = typename Graph::HeapElement;
+
+    WeightT bestTime = numeric_limits<WeightT>::max();
+    if (pruneByDestination && bracket.upper < bestTime) {
+        bestTime = bracket.upper + 1;
+    }
+    const WeightT floorTime = max(bounds.time(source), bracket.lower);
+    const auto& tail = state.frontierTail;
+    const auto& csr = g.csr();
+    SearchCounters& counters = state.counters;
+
+    while (!pq.empty()) {
+        HeapElement top = pq.top();
+        pq.pop();
+        counters.onPop();
+        const VertexT v = top.vertex;
+        const PathSignature& key = top.pathSignature;
+
+        // Pushed before the destination improved; can no longer help.
+        if (key.time >= bestTime) {
+            counters.onDominancePrune();
+            continue;
+        }
+
+        PathSignature label(key.cost - bounds.cost(v), key.time - bounds.time(v));
+        // An empty S[v] has tail max(), above every label time (see
+        // largestLabelWeight()), so the first label always passes.
+        if (tail[v] <= label.time) {
+            counters.onDominancePrune();
+            continue; // dominated by an earlier (cheaper or equal) label
+        }
+        uint32_t id;
+        WeightT pathTime = label.time;
+        if constexpr (Dominance::approximate) {
+            uint32_t parent;
+            if (!dominance.settle(top.parent, label, parent, pathTime)) {
+                counters.onDominancePrune();
+                continue; // merged into another entry, or queued again
+            }
+            id = state.appendPath(v, PathSignature(label.cost, pathTime), parent);
+            state.frontierTail[v] = label.time;
+            onSettled(v, PathSignature(label.cost, pathTime));
+        } else {
+            id = state.appendPath(v, label, top.parent);
+            onSettled(v, label);
+        }
+
+        if (v == destination) {
+            if (pruneByDestination) {
+                bestTime = min(bestTime, pathTime);
+                if (bestTime <= floorTime) {
+                    break; // nothing can be faster than the time bound
+                }
+            }
+            continue;
+        }
+
+        // Edges that fit the budget, can beat bestTime and are not
+        // dominated at the neighbor, tested a vector of edges at a time
+        // before the bounds are added (see relax_kernels.h). The frontier
+        // pre-check is the same one comparison as on pop; the algorithm is
+        // still correct without it.
+        const uint64_t first = csr.offsets[v];
+        const size_t degree = csr.offsets[v + 1] - first;
+        if (state.relaxKeep.size() < degree) {
+            state.relaxKeep.resize(degree);
+        }
+        size_t kept = relaxFilter(csr.targets + first, csr.costs + first, csr.times + first, degree, label.cost,
+                                  label.time, budget, bestTime, tail.data(), state.relaxKeep.data());
+        if constexpr (SearchCounters::enabled) {
+            // The filter's rejects over budget; the rest were dominated
+            size_t overBudget = 0;
+            for (size_t i = 0; i < degree; ++i) {
+                overBudget += !sumWithin(label.cost, csr.costs[first + i], budget);
+            }
+            counters.onGenerated(degree);
+            counters.onBudgetPrune(overBudget);
+            counters.onDominancePrune(degree - kept - overBudget);
+        }
+        for (size_t k = 0; k < kept; ++k) {
+            const size_t e = first + state.relaxKeep[k];
+            const VertexT neighbor = csr.targets[e];
+            if (!bounds.reachable(neighbor)) {
+                counters.onBudgetPrune();
+                continue;
+            }
+            // The filter kept newCost <= budget and newTime < bestTime
+            WeightT newCost = label.cost + csr.costs[e];
+            WeightT newTime = label.time + csr.times[e];
+            if (!sumWithin(newCost, bounds.cost(neighbor), budget)) {
+                counters.onBudgetPrune();
+                continue;
+            }
+            if (!sumBelow(newTime, bounds.time(neighbor), bestTime)) {
+                counters.onDominancePrune();
+                continue;
+            }
+            WeightT costKey = newCost + bounds.cost(neighbor);
+            WeightT timeKey = newTime + bounds.time(neighbor);
+            if constexpr (Dominance::approximate) {
+                if (!sumWithin(pathTime, csr.times[e], numeric_limits<WeightT>::max())) {
+                    counters.onDominancePrune();
+                    continue; // the path's own time would not fit the type
+                }
+                PathSignature apex(newCost, newTime);
+                uint32_t item;
+                if (!dominance.open(neighbor, id, WeightT(pathTime + csr.times[e]), apex, item)) {
+                    counters.onDominancePrune();
+                    continue;
+                }
+                pq.push(HeapElement(PathSignature(apex.cost + bounds.cost(neighbor), apex.time + bounds.time(neighbor)),
+                                    neighbor, item));
+            } else {
+                pq.push(HeapElement(PathSignature(costKey, timeKey), neighbor, id));
+            }
+            counters.onPush(pq.size());
+        }
+    }
+}
+
+// labelSettingLoop()'s default settle hook
+struct IgnoreSettled {
+    template<typename VertexT, typename Label>
+    void operator()(const VertexT&, const Label&) const {}
+};
+
+// Resets the workspace and the dominance policy, seeds the source and runs
+// labelSettingLoop() over the bucket queue when bucketSpan is non-zero,
+// the binary heap otherwise.
+template<typename VertexT, typename WeightT, typename Bounds = NoBounds, typename Dominance = ExactDominance,
+         typename OnSettled = IgnoreSettled>
+void labelSettingSearch(const graph<VertexT, WeightT>& g,
+                        typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+                        const VertexT& source, const VertexT& destination,
+                        const WeightT& budget, bool pruneByDestination,
+                        const Bounds& bounds = Bounds(), size_t bucketSpan = 0,
+                        Dominance&& dominance = Dominance(), OnSettled&& onSettled = OnSettled(),
+                        const TimeBracket<WeightT>& bracket = TimeBracket<WeightT>()) {
+    using PathSignature = typename graph<VertexT, WeightT>::PathSignature;
+
+    dominance.reset();
+    if (!bounds.reachable(source)) {
+        // Still reset the workspace so S[destination] reads as empty.
+        state.initialize(source);
+        state.priorityQueue.pop();
+        return;
+    }
+    state.initialize(source, PathSignature(bounds.cost(source), bounds.time(source)), bucketSpan);
+    if (bucketSpan > 0) {
+        labelSettingLoop(g, state, state.bucketQueue, source, destination, budget, pruneByDestination, bounds,
+                         dominance, onSettled, bracket);
+    } else {
+        labelSettingLoop(g, state, state.priorityQueue, source, destination, budget, pruneByDestination, bounds,
+                         dominance, onSettled, bracket);
+    }
+}
+
+// Which queue holds a search's labels
+enum class LabelQueue { Heap, Buckets, Auto };
+
+// Auto mode only picks buckets up to this many
+const size_t LABEL_BUCKET_LIMIT = 1 << 16;
+
+// Bucket count a search needs, or 0 for the binary heap.
+//
+// Every queued key lies within one edge step of the key being popped: an
+// edge's cost, or with bounds up to twice that (c(v,w) + lb(w) - lb(v) and
+// |lb(w) - lb(v)| <= c(v,w) on an undirected graph). Keys also never exceed
+// the budget, so min(step, budget) + 1 buckets suffice. Auto falls back to
+// the heap when that span is large, since a wide, sparsely used key range
+// makes the bucket scan and its memory cost more than the heap saves.
+template<typename WeightT>
+size_t labelBucketSpan(LabelQueue kind, const WeightT& maxEdgeCost, const WeightT& budget, bool bounded) {
+    if (kind == LabelQueue::Heap) {
+        return 0;
+    }
+    uint64_t step = uint64_t(maxEdgeCost) * (bounded ? 2 : 1);
+    uint64_t span = min<uint64_t>(step, uint64_t(max<WeightT>(budget, 0))) + 1;
+    if (kind == LabelQueue::Auto && span > LABEL_BUCKET_LIMIT) {
+        return 0;
+    }
+    return span;
+}
+
+// Picks the fastest entry of a frontier (cost ascending, time descending)
+// that fits the budget: the last one with cost <= budget, found by binary
+// search.
+template<typename WeightT, typename Frontier>
+ConstrainedResult<WeightT> fastestWithinBudget(const Frontier& frontier, const WeightT& budget) {
+    ConstrainedResult<WeightT> result;
+    auto fits = upper_bound(frontier.begin(), frontier.end(), budget,
+                            [](const WeightT& b, const auto& ps) { return b < ps.cost; });
+    if (fits != frontier.begin()) {
+        --fits;
+        result.found = true;
+        result.cost = fits->cost;
+        result.time = fits->time;
+        result.forwardLabel = fits->label;
+    }
+    return result;
+}
+
+// Vertices of a result's path, source first: the forward label's path,
+// followed by the backward label's path (which runs destination first)
+// reversed. Only valid until either state is reused.
+template<typename State, typename WeightT>
+auto resultPath(const State& forward, const State& backward, const ConstrainedResult<WeightT>& result) {
+    decltype(forward.pathTo(NO_LABEL)) path;
+    if (result.forwardLabel != NO_LABEL) {
+        path = forward.pathTo(result.forwardLabel);
+    }
+    if (result.backwardLabel != NO_LABEL) {
+        auto tail = backward.pathTo(result.backwardLabel);
+        path.insert(path.end(), tail.rbegin(), tail.rend());
+    }
+    return path;
+}
+
+// Representatives settle in apex order, so under EpsilonDominance a
+// destination's S[v] is cost ascending but may hold entries an earlier,
+// cheaper one is at least as fast as; this drops them, leaving the usual
+// cost ascending / time descending frontier.
+template<typename Frontier>
+Frontier approximateFrontier(const Frontier& settled) {
+    Frontier frontier;
+    for (const auto& ps : settled) {
+        if (frontier.empty() || ps.time < frontier.back().time) {
+            frontier.push_back(ps);
+        }
+    }
+    return frontier;
+}
+
+// Fastest path from source to destination whose cost fits the budget.
+// Uses the destination pruning described above, so it settles far fewer
+// labels than computing the whole frontier. A bracket known beforehand
+// (see lagrangian.h) tightens that pruning; the answer must lie in it.
+template<typename VertexT, typename WeightT, typename Bounds = NoBounds, typename Dominance = ExactDominance>
+ConstrainedResult<WeightT> paretoSearch(const graph<VertexT, WeightT>& g,
+                                        typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+                                        const VertexT& source, const VertexT& destination,
+                                        const WeightT& budget, const Bounds& bounds = Bounds(),
+                                        size_t bucketSpan = 0, Dominance&& dominance = Dominance(),
+                                        const TimeBracket<WeightT>& bracket = TimeBracket<WeightT>()) {
+    labelSettingSearch(g, state, source, destination, budget, true, bounds, bucketSpan, dominance,
+                       IgnoreSettled(), bracket);
+    if constexpr (!remove_reference_t<Dominance>::approximate) {
+        return fastestWithinBudget(state.nonDominatedPaths[destination], budget);
+    } else {
+        // The destination's apexes bound every in-budget time from below
+        // (and anything bestTime cut off is no faster than the answer), so
+        // the answer over the fastest apex is the factor actually achieved.
+        auto frontier = approximateFrontier(state.nonDominatedPaths[destination]);
+        ConstrainedResult<WeightT> result = fastestWithinBudget(frontier, budget);
+        WeightT lowest = min(result.time, state.frontierTail[destination]);
+        if (result.found && result.time > lowest) {
+            result.approximation = lowest > 0 ? double(result.time) / double(lowest) : 1 + dominance.epsilon();
+        }
+        return result;
+    }
+}
+
+// The destination's complete non-dominated (cost, time) frontier, cost
+// ascending / time descending, optionally capped at maxBudget. One search
+// answers every budget up to the cap through fastestWithinBudget(). Under
+// EpsilonDominance it is approximate: every exact frontier entry has one
+// here that is no more expensive and at most 1 + epsilon times as slow.
+template<typename VertexT, typename WeightT, typename Bounds = NoBounds, typename Dominance = ExactDominance>
+typename graph<VertexT, WeightT>::NonDominatedPathsSet
+paretoFrontier(const graph<VertexT, WeightT>& g,
+               typename graph<VertexT, WeightT>::GraphAlgorithmState& state,
+               const VertexT& source, const VertexT& destination,
+               const WeightT& maxBudget = numeric_limits<WeightT>::max(),
+               const Bounds& bounds = Bounds(), size_t bucketSpan = 0, Dominance&& dominance = Dominance()) {
+    labelSettingSearch(g, state, source, destination, maxBudget, false, bounds, bucketSpan, dominance);
+    if constexpr (remove_reference_t<Dominance>::approximate) {
+        return approximateFrontier(state.nonDominatedPaths[destination]);
+    }
+    return state.nonDominatedPaths[destination];
+}
+
+// Size of the frontiers a search left behind, for choosing epsilon
+struct FrontierSizes {
+    size_t vertices = 0; // with at least one settled label
+    size_t labels = 0;   // settled in all
+    size_t largest = 0;  // largest |S[v]|
+    size_t p99 = 0;      // 99th percentile of |S[v]| (nearest rank)
+};
+
+// Appends |S[v]| of every vertex with a settled label to sizes
+template<typename State>
+void appendFrontierSizes(const State& state, vector<size_t>& sizes) {
+    for (const auto& v : state.touchedVertices) {
+        sizes.push_back(state.nonDominatedPaths[v].size());
+    }
+}
+
+// Summarizes frontier sizes gathered by appendFrontierSizes(), possibly
+// from several states
+inline FrontierSizes summarizeFrontierSizes(vector<size_t> sizes) {
+    FrontierSizes summary;
+    summary.vertices = sizes.size();
+    for (size_t n : sizes) {
+        summary.labels += n;
+        summary.largest = max(summary.largest, n);
+    }
+    if (!sizes.empty()) {
+        size_t rank = (sizes.size() * 99 + 99) / 100 - 1;
+        nth_element(sizes.begin(), sizes.begin() + rank, sizes.end());
+        summary.p99 = sizes[rank];
+    }
+    return summary;
+}
+
+template<typename State>
+FrontierSizes frontierSizes(const State& state) {
+    vector<size_t> sizes;
+    appendFrontierSizes(state, sizes);
+    return summarizeFrontierSizes(move(sizes));
+}
+
+// One-to-all sweep: the non-dominated frontier of every vertex reachable
+// from source within maxBudget, handed to emit(v, frontier) (cost
+// ascending, time descending) as soon as it is final rather than when the
+// sweep ends.
+//
+// fastest must be a LowerBounds computed from source up to maxBudget; the
+// graph stores both edge directions, so its time() is a lower bound on
+// the time of any in-budget path from source. Labels settle in cost
+// order, so everything settled at v later is at least as expensive; once
+// S[v] holds a label as fast as the bound, nothing later can be faster
+// either and v's frontier is final. Vertices that never reach their bound
+// (the fastest path to them does not fit the budget) are emitted when the
+// queue runs out. The frontier passed to emit stays valid until the next
+// search on state.
+template<typename VertexT, typename WeightT, typename Emit>
+void paretoOneToAll(const graph<VertexT, WeightT>& g,
+                    typename graph<VertexT, WeightT>::GraphAlgorithmState& state, const VertexT& source,
+                    const WeightT& maxBudget, const LowerBounds<VertexT, WeightT>& fastest, Emit&& emit,
+                    size_t bucketSpan = 0) {
+    using PathSignature = typename graph<VertexT, WeightT>::PathSignature;
+
+    vector<char> emitted(g.NumVertices(), 0);
+    auto onSettled = [&](const VertexT& v, const PathSignature& label) {
+        if (label.time == fastest.time(v)) {
+            emitted[v] = 1;
+            emit(v, state.nonDominatedPaths[v]);
+        }
+    };
+    const VertexT nowhere = VertexT(g.NumVertices());
+    labelSettingSearch(g, state, source, nowhere, maxBudget, false, NoBounds(), bucketSpan, ExactDominance(),
+                       onSettled);
+    for (const VertexT& v : state.touchedVertices) {
+        if (!emitted[v]) {
+            emit(v, state.nonDominatedPaths[v]);
+        }
+    }
+}
+
+// Bidirectional exact search for the fastest in-budget path.
+//
+// A forward label-setting search from source and a backward one from
+// destination each settle only labels up to half the budget: forward up
+// to floor(budget / 2), backward up to budget - floor(budget / 2) - 1.
+// Along any in-budget s-d path, the last vertex whose prefix fits the
+// forward half is followed by an edge whose suffix fits the backward half,
+// so every path is matched across some edge (u, w) by a settled forward
+// label at u and a settled backward label at w that together are at least
+// as good. Whenever a label settles, each of its edges is matched against
+// the other side's frontier at the far end; that frontier is cost
+// ascending / time descending, so the fastest partner that still fits the
+// budget is found by binary search, once the frontier's fastest label
+// shows a match could beat the incumbent. Labels that cannot beat the
+// incumbent are dropped.
+//
+// The half-budget split is the only other stopping rule. Each side
+// settles its whole half unless the incumbent prunes it, so the engine
+// loses to the unidirectional one when that one reaches the destination
+// early, or when one end is poorly connected and the other side searches
+// its half for nothing.
+//
+// The graph stores every edge in both directions, so the backward search
+// walks the same CSR rows as the forward one. Ties on time go to the
+// cheaper path, which is what the unidirectional engine returns. The result
+// names the matched label on each side; resultPath() joins them.
+template<typename VertexT, typename WeightT>
+ConstrainedResult<WeightT> bidirectionalParetoSearch(const graph<VertexT, WeightT>& g,
+                                                     typename graph<VertexT, WeightT>::GraphAlgorithmState& forward,
+                                                     typename graph<VertexT, WeightT>::GraphAlgorithmState& backward,
+                                                     const VertexT& source, const VertexT& destination,
+                                                     const WeightT& budget) {
+    using Graph = graph<VertexT, WeightT>;
+    using PathSignature = typename Graph::PathSignature;
+    using HeapElement = typename Graph::HeapElement;
+    using State = typename Graph::GraphAlgorithmState;
+
+    ConstrainedResult<WeightT> best;
+    auto offer = [&](const WeightT& cost, const WeightT& time, uint32_t forwardLabel, uint32_t backwardLabel) {
+        if (!best.found || time < best.time || (time == best.time && cost < best.cost)) {
+            best.found = true;
+            best.cost = cost;
+            best.time = time;
+            best.forwardLabel = forwardLabel;
+            best.backwardLabel = backwardLabel;
+        }
+    };
+    // A label no extension of which can beat the incumbent: as slow and
+    // no cheaper, since extending only adds cost and time
+    auto beaten = [&](const WeightT& cost, const WeightT& time) {
+        return best.found && (time > best.time || (time == best.time && cost >= best.cost));
+    };
+
+    if constexpr (is_signed<WeightT>::value) {
+        if (budget < 0) {
+            return best;
+        }
+    }
+    // Joined paths, like labels, stay within largestLabelWeight()
+    const WeightT costLimit = min(budget, largestLabelWeight<WeightT>());
+    const WeightT forwardLimit = costLimit / 2;
+    const WeightT backwardLimit = max<WeightT>(costLimit - forwardLimit - 1, 0);
+
+    forward.initialize(source);
+    backward.initialize(destination);
+
+    // Settles the next label of one side and matches it against the other.
+    auto step = [&](State& self, State& other, const VertexT& target, const WeightT& limit, bool isForward) {
+        auto offerPair = [&](const WeightT& cost, const WeightT& time, uint32_t selfLabel, uint32_t otherLabel) {
+            if (isForward) {
+                offer(cost, time, selfLabel, otherLabel);
+            } else {
+                offer(cost, time, otherLabel, selfLabel);
+            }
+        };
+
+        HeapElement top = self.priorityQueue.top();
+        self.priorityQueue.pop();
+        self.counters.onPop();
+        const PathSignature& label = top.pathSignature;
+
+        if (beaten(label.cost, label.time)) {
+            self.counters.onDominancePrune();
+            return;
+        }
+        if (self.frontierTail[top.vertex] <= label.time) {
+            self.counters.onDominancePrune();
+            return;
+        }
+        uint32_t id = self.appendPath(top.vertex, label, top.parent);
+
+        if (top.vertex == target) {
+            offerPair(label.cost, label.time, id, NO_LABEL);
+            return;
+        }
+
+        for (const auto& edge : g.edges(top.vertex)) {
+            self.counters.onGenerated(1);
+            if (!sumWithin(label.cost, edge.cost, budget) ||
+                !sumWithin(label.time, edge.time, numeric_limits<WeightT>::max())) {
+                self.counters.onBudgetPrune();
+                continue;
+            }
+            WeightT newCost = label.cost + edge.cost;
+            WeightT newTime = label.time + edge.time;
+
+            // The far end's fastest label (max() when it has none) bounds
+            // every partner there, which rules most edges out before the
+            // binary search
+            if (sumWithin(newTime, other.frontierTail[edge.target],
+                          best.found ? best.time : largestLabelWeight<WeightT>())) {
+                ConstrainedResult<WeightT> partner =
+                    fastestWithinBudget(other.nonDominatedPaths[edge.target], WeightT(costLimit - newCost));
+                if (partner.found && sumWithin(newTime, partner.time, numeric_limits<WeightT>::max())) {
+                    offerPair(newCost + partner.cost, newTime + partner.time, id, partner.forwardLabel);
+                }
+            }
+
+            if (newCost > limit) {
+                // past this side's half of the budget; the other side's
+                // labels cover the rest
+                self.counters.onBudgetPrune();
+                continue;
+            }
+            if (beaten(newCost, newTime) || self.frontierTail[edge.target] <= newTime) {
+                self.counters.onDominancePrune();
+                continue;
+            }
+            self.priorityQueue.push(HeapElement(PathSignature(newCost, newTime), edge.target, id));
+            self.counters.onPush(self.priorityQueue.size());
+        }
+    };
+
+    // Alternate by the cheaper queue head, like bidirectional Dijkstra.
+    auto& fq = forward.priorityQueue;
+    auto& bq = backward.priorityQueue;
+    while (!fq.empty() || !bq.empty()) {
+        bool pickForward = bq.empty() ||
+                           (!fq.empty() && fq.top().pathSignature.cost <= bq.top().pathSignature.cost);
+        if (pickForward) {
+            step(forward, backward, destination, forwardLimit, true);
+        } else {
+            step(backward, forward, source, backwardLimit, false);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CPATH_X86_KERNELS 1
+#endif
+
+using namespace std;
+
+// Edge filter for label relaxation. Given the label (cost, time) being
+// expanded and one CSR row, writes to keep[] the row offsets i whose edge
+// gives a label that
+//
+//     fits:      cost + costs[i] <= costLimit
+//     can help:  time + times[i] <  timeLimit
+//     survives:  time + times[i] <  frontierTail[targets[i]]
+//
+// in row order, and returns how many there are. keep[] must have room for
+// count entries. frontierTail[w] is the time of the last label in S[w] (see
+// GraphAlgorithmState), so the third test is the usual dominance
+// pre-check. Lower bounds are non-negative, so the searches' bound-aware
+// tests imply the first two; the survivors still go through those.
+//
+// The sums are never formed: weights are non-negative, and each test
+// compares the edge's weight with the room left between the label and the
+// limit, so none of them can overflow however large the weights. Costs
+// stop one short of the type's maximum, like every path sum (see
+// largestLabelWeight() in graph.h). A label already past a limit keeps no
+// edges.
+//
+// The CSR row and frontierTail are both structure-of-arrays, so the
+// vector kernels test 4 (SSE2) or 8 (AVX2, with a gather for the tails)
+// edges at a time. The kernel is picked at run time from what the CPU
+// supports (see selectRelaxKernel()); 32-bit vertices and weights use it,
+// other types always take the scalar loop.
+
+enum class RelaxKernel { Auto, Scalar, SSE2, AVX2 };
+
+template<typename VertexT, typename WeightT>
+size_t relaxFilterScalar(const VertexT* targets, const WeightT* costs, const WeightT* times, size_t count,
+                         WeightT cost, WeightT time, WeightT costLimit, WeightT timeLimit,
+                         const WeightT* frontierTail, uint32_t* keep) {
+    if (costLimit == numeric_limits<WeightT>::max()) {
+        --costLimit;
+    }
+    if (cost > costLimit || time >= timeLimit) {
+        return 0;
+    }
+    const WeightT costRoom = costLimit - cost;
+    const WeightT timeRoom = timeLimit - time;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const WeightT tail = frontierTail[targets[i]];
+        if (costs[i] <= costRoom && times[i] < timeRoom && time < tail && times[i] < tail - time) {
+            keep[kept++] = uint32_t(i);
+        }
+    }
+    return kept;
+}
+
+#ifdef CPATH_X86_KERNELS
+// The vector kernels' leftover edges begin..count-1, offsets still
+// relative to the row start
+inline size_t relaxFilterScalarTail(const int32_t* targets, const int32_t* costs, const int32_t* times,
+                                    size_t begin, size_t count, int32_t cost, int32_t time, int32_t costLimit,
+                                    int32_t timeLimit, const int32_t* frontierTail, uint32_t* keep) {
+    size_t kept = relaxFilterScalar(targets + begin, costs + begin, times + begin, count - begin, cost, time,
+                                    costLimit, timeLimit, frontierTail, keep);
+    for (size_t k = 0; k < kept; ++k) {
+        keep[k] += uint32_t(begin);
+    }
+    return kept;
+}
+
+// Appends the offsets of the set bits of a lane mask
+inline size_t relaxKeepLanes(unsigned mask, size_t base, uint32_t* keep, size_t kept) {
+    while (mask != 0) {
+        keep[kept++] = uint32_t(base + __builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+    return kept;
+}
+
+__attribute__((target("sse2")))
+inline size_t relaxFilterSSE2(const int32_t* targets, const int32_t* costs, const int32_t* times, size_t count,
+                              int32_t cost, int32_t time, int32_t costLimit, int32_t timeLimit,
+                              const int32_t* frontierTail, uint32_t* keep) {
+    if (costLimit == INT32_MAX) {
+        --costLimit;
+    }
+    if (cost > costLimit || time >= timeLimit) {
+        return 0;
+    }
+    const __m128i t = _mm_set1_epi32(time);
+    const __m128i costRoom = _mm_set1_epi32(costLimit - cost);
+    const __m128i timeRoom = _mm_set1_epi32(timeLimit - time);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i ec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(costs + i));
+        __m128i et = _mm_loadu_si128(reinterpret_cast<const __m128i*>(times + i));
+        __m128i tail = _mm_set_epi32(frontierTail[targets[i + 3]], frontierTail[targets[i + 2]],
+                                     frontierTail[targets[i + 1]], frontierTail[targets[i]]);
+        __m128i tailRoom = _mm_sub_epi32(tail, t); // both non-negative: no overflow
+        __m128i ok = _mm_andnot_si128(_mm_cmpgt_epi32(ec, costRoom),
+                                      _mm_and_si128(_mm_cmpgt_epi32(timeRoom, et), _mm_cmpgt_epi32(tailRoom, et)));
+        kept = relaxKeepLanes(_mm_movemask_ps(_mm_castsi128_ps(ok)), i, keep, kept);
+    }
+    return kept + relaxFilterScalarTail(targets, costs, times, i, count, cost, time, costLimit, timeLimit,
+                                        frontierTail, keep + kept);
+}
+
+__attribute__((target("avx2")))
+inline size_t relaxFilterAVX2(const int32_t* targets, const int32_t* costs, const int32_t* times, size_t count,
+                              int32_t cost, int32_t time, int32_t costLimit, int32_t timeLimit,
+                              const int32_t* frontierTail, uint32_t* keep) {
+    if (costLimit == INT32_MAX) {
+        --costLimit;
+    }
+    if (cost > costLimit || time >= timeLimit) {
+        return 0;
+    }
+    const __m256i t = _mm256_set1_epi32(time);
+    const __m256i costRoom = _mm256_set1_epi32(costLimit - cost);
+    const __m256i timeRoom = _mm256_set1_epi32(timeLimit - time);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i ec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(costs + i));
+        __m256i et = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(times + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(targets + i));
+        __m256i tailRoom = _mm256_sub_epi32(_mm256_i32gather_epi32(frontierTail, w, 4), t);
+        __m256i ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(ec, costRoom),
+                                         _mm256_and_si256(_mm256_cmpgt_epi32(timeRoom, et),
+                                                          _mm256_cmpgt_epi32(tailRoom, et)));
+        kept = relaxKeepLanes(_mm256_movemask_ps(_mm256_castsi256_ps(ok)), i, keep, kept);
+    }
+    return kept + relaxFilterScalarTail(targets, costs, times, i, count, cost, time, costLimit, timeLimit,
+                                        frontierTail, keep + kept);
+}
+#endif
+
+using RelaxFilter32 = size_t (*)(const int32_t*, const int32_t*, const int32_t*, size_t, int32_t, int32_t,
+                                 int32_t, int32_t, const int32_t*, uint32_t*);
+
+// The kernel in use for 32-bit weights
+struct RelaxKernelChoice {
+    RelaxKernel kind = RelaxKernel::Scalar;
+    RelaxFilter32 filter = relaxFilterScalar<int32_t, int32_t>;
+};
+
+inline bool relaxKernelSupported(RelaxKernel kind) {
+    switch (kind) {
+    case RelaxKernel::Auto:
+    case RelaxKernel::Scalar:
+        return true;
+#ifdef CPATH_X86_KERNELS
+    case RelaxKernel::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case RelaxKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+// The kernel for a given kind, which must be supported; Auto picks the
+// widest one the CPU has.
+inline RelaxKernelChoice relaxKernelFor(RelaxKernel kind) {
+    RelaxKernelChoice choice;
+#ifdef CPATH_X86_KERNELS
+    if (kind == RelaxKernel::Auto) {
+        kind = relaxKernelSupported(RelaxKernel::AVX2)   ? RelaxKernel::AVX2
+               : relaxKernelSupported(RelaxKernel::SSE2) ? RelaxKernel::SSE2
+                                                         : RelaxKernel::Scalar;
+    }
+    if (kind == RelaxKernel::AVX2) {
+        choice.kind = kind;
+        choice.filter = relaxFilterAVX2;
+    } else if (kind == RelaxKernel::SSE2) {
+        choice.kind = kind;
+        choice.filter = relaxFilterSSE2;
+    }
+#endif
+    return choice;
+}
+
+inline RelaxKernelChoice& relaxKernelChoice() {
+    static RelaxKernelChoice choice = relaxKernelFor(RelaxKernel::Auto);
+    return choice;
+}
+
+// Overrides the automatic choice; Auto restores it. Call before any search
+// starts. Returns false, leaving the choice alone, if this build or CPU
+// cannot run the kernel.
+inline bool selectRelaxKernel(RelaxKernel kind) {
+    if (!relaxKernelSupported(kind)) {
+        return false;
+    }
+    relaxKernelChoice() = relaxKernelFor(kind);
+    return true;
+}
+
+template<typename VertexT, typename WeightT>
+size_t relaxFilter(const VertexT* targets, const WeightT* costs, const WeightT* times, size_t count, WeightT cost,
+                   WeightT time, WeightT costLimit, WeightT timeLimit, const WeightT* frontierTail,
+                   uint32_t* keep) {
+    if constexpr (is_same<VertexT, int32_t>::value && is_same<WeightT, int32_t>::value) {
+        return relaxKernelChoice().filter(targets, costs, times, count, cost, time, costLimit, timeLimit,
+                                          frontierTail, keep);
+    } else {
+        return relaxFilterScalar(targets, costs, times, count, cost, time, costLimit, timeLimit, frontierTail,
+                                 keep);
+    }
+}
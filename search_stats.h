@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Counters a label search keeps for tuning, compiled in only when
+// CPATH_STATS is defined (make STATS=1). Without it every member function
+// is an empty inline one and enabled is false, so the search loops that
+// call them compile to what they were without counters.
+//
+//   generated          labels made by extending a settled label over an edge
+//   prunedByBudget     generated labels dropped because their cost (plus the
+//                      cost bound, when there is one) exceeds the budget
+//   prunedByDominance  labels dropped because a settled label dominates
+//                      them: one at their vertex or, through the time
+//                      bound, the best destination label so far
+//   pushes, pops       queue operations; peakQueue is the longest the
+//                      queue got
+struct SearchCounters {
+#ifdef CPATH_STATS
+    static constexpr bool enabled = true;
+
+    uint64_t generated = 0;
+    uint64_t prunedByBudget = 0;
+    uint64_t prunedByDominance = 0;
+    uint64_t pushes = 0;
+    uint64_t pops = 0;
+    size_t peakQueue = 0;
+
+    void onGenerated(uint64_t n) {
+        generated += n;
+    }
+
+    void onBudgetPrune(uint64_t n = 1) {
+        prunedByBudget += n;
+    }
+
+    void onDominancePrune(uint64_t n = 1) {
+        prunedByDominance += n;
+    }
+
+    // queueSize is the queue's length after the push
+    void onPush(size_t queueSize) {
+        ++pushes;
+        peakQueue = max(peakQueue, queueSize);
+    }
+
+    void onPop() {
+        ++pops;
+    }
+
+    SearchCounters& operator+=(const SearchCounters& other) {
+        generated += other.generated;
+        prunedByBudget += other.prunedByBudget;
+        prunedByDominance += other.prunedByDominance;
+        pushes += other.pushes;
+        pops += other.pops;
+        peakQueue = max(peakQueue, other.peakQueue);
+        return *this;
+    }
+#else
+    static constexpr bool enabled = false;
+
+    void onGenerated(uint64_t) {}
+    void onBudgetPrune(uint64_t = 1) {}
+    void onDominancePrune(uint64_t = 1) {}
+    void onPush(size_t) {}
+    void onPop() {}
+
+    SearchCounters& operator+=(const SearchCounters&) {
+        return *this;
+    }
+#endif
+};
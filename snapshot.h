@@ -0,0 +1,210 @@
+#pragma once
+
+#include "graph.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+// Binary graph snapshot: a frozen graph's CSR arrays written out as-is so
+// they can be mmap'ed back with no parsing. Every process that maps the
+// same snapshot shares its pages through the page cache.
+//
+// Layout (native byte order, checked through endianTag):
+//
+//     SnapshotHeader
+//     offsets[numVertices + 1]   uint64_t
+//     targets[numEdges]          VertexT
+//     costs[numEdges]            WeightT
+//     times[numEdges]            WeightT
+//
+// Each array starts on a SNAPSHOT_ALIGNMENT boundary. numEdges counts
+// directed CSR entries, i.e. both directions of every input edge.
+
+const char SNAPSHOT_MAGIC[8] = {'C', 'P', 'A', 'T', 'H', 'S', 'N', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_ENDIAN_TAG = 0x01020304;
+const uint64_t SNAPSHOT_ALIGNMENT = 64;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint32_t vertexBytes;   // sizeof(VertexT)
+    uint32_t weightBytes;   // sizeof(WeightT)
+    uint32_t weightSigned;  // is_signed<WeightT>
+    uint32_t reserved;
+    uint64_t numVertices;
+    uint64_t numEdges;
+    uint64_t offsetsPos;    // byte positions of the arrays in the file
+    uint64_t targetsPos;
+    uint64_t costsPos;
+    uint64_t timesPos;
+    uint64_t fileSize;
+    uint64_t offsetsChecksum;
+    uint64_t targetsChecksum;
+    uint64_t costsChecksum;
+    uint64_t timesChecksum;
+    uint64_t headerChecksum; // over every field above
+};
+
+// 64-bit FNV-1a style hash taken a word at a time, so checksumming runs
+// at close to memory bandwidth.
+inline uint64_t snapshotChecksum(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+inline uint64_t snapshotAlign(uint64_t pos) {
+    return (pos + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+inline bool isSnapshot(const char* data, size_t size) {
+    return size >= sizeof(SNAPSHOT_MAGIC) && memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+}
+
+// Writes a frozen graph as a snapshot. Returns false (with a message on
+// cerr) if the file cannot be written.
+template<typename VertexT, typename WeightT>
+bool writeSnapshot(const string& filename, const graph<VertexT, WeightT>& g) {
+    const auto& csr = g.csr();
+    size_t offsetsBytes = (csr.numVertices + 1) * sizeof(uint64_t);
+    size_t targetsBytes = csr.numEdges * sizeof(VertexT);
+    size_t weightsBytes = csr.numEdges * sizeof(WeightT);
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.endianTag = SNAPSHOT_ENDIAN_TAG;
+    header.vertexBytes = sizeof(VertexT);
+    header.weightBytes = sizeof(WeightT);
+    header.weightSigned = is_signed<WeightT>::value;
+    header.numVertices = csr.numVertices;
+    header.numEdges = csr.numEdges;
+    header.offsetsPos = snapshotAlign(sizeof(SnapshotHeader));
+    header.targetsPos = snapshotAlign(header.offsetsPos + offsetsBytes);
+    header.costsPos = snapshotAlign(header.targetsPos + targetsBytes);
+    header.timesPos = snapshotAlign(header.costsPos + weightsBytes);
+    header.fileSize = header.timesPos + weightsBytes;
+    header.offsetsChecksum = snapshotChecksum(csr.offsets, offsetsBytes);
+    header.targetsChecksum = snapshotChecksum(csr.targets, targetsBytes);
+    header.costsChecksum = snapshotChecksum(csr.costs, weightsBytes);
+    header.timesChecksum = snapshotChecksum(csr.times, weightsBytes);
+    header.headerChecksum = snapshotChecksum(&header, offsetof(SnapshotHeader, headerChecksum));
+
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Error: Unable to open snapshot file " << filename << " for writing" << endl;
+        return false;
+    }
+    uint64_t pos = 0;
+    auto writeAt = [&](uint64_t at, const void* data, size_t size) {
+        static const char padding[SNAPSHOT_ALIGNMENT] = {};
+        out.write(padding, at - pos);
+        out.write(static_cast<const char*>(data), size);
+        pos = at + size;
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.offsetsPos, csr.offsets, offsetsBytes);
+    writeAt(header.targetsPos, csr.targets, targetsBytes);
+    writeAt(header.costsPos, csr.costs, weightsBytes);
+    writeAt(header.timesPos, csr.times, weightsBytes);
+    out.close();
+    if (!out) {
+        cerr << "Error: failed writing snapshot file " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+// Attaches the graph to a mapped snapshot. The header (magic, version,
+// types, sizes, header checksum) is always validated; the array checksums
+// touch every page of the file, so they are only checked when
+// verifyArrays is set. Returns false with a message on cerr on mismatch.
+template<typename VertexT, typename WeightT>
+bool attachSnapshot(shared_ptr<const MappedFile> file, const string& filename,
+                    graph<VertexT, WeightT>& g, bool verifyArrays = false) {
+    SnapshotHeader header;
+    if (!isSnapshot(file->data(), file->size())) {
+        cerr << "Error: " << filename << " is not a graph snapshot" << endl;
+        return false;
+    }
+    auto fail = [&](const char* why) {
+        cerr << "Error: snapshot " << filename << ": " << why << endl;
+        return false;
+    };
+    if (file->size() < sizeof(header)) {
+        return fail("truncated header");
+    }
+    memcpy(&header, file->data(), sizeof(header));
+    if (header.version != SNAPSHOT_VERSION) {
+        return fail("unsupported version");
+    }
+    if (header.endianTag != SNAPSHOT_ENDIAN_TAG) {
+        return fail("written on a machine with different byte order");
+    }
+    if (header.headerChecksum != snapshotChecksum(&header, offsetof(SnapshotHeader, headerChecksum))) {
+        return fail("header checksum mismatch");
+    }
+    if (header.vertexBytes != sizeof(VertexT) || header.weightBytes != sizeof(WeightT) ||
+        header.weightSigned != uint32_t(is_signed<WeightT>::value)) {
+        return fail("vertex/weight types do not match this build");
+    }
+    size_t offsetsBytes = (header.numVertices + 1) * sizeof(uint64_t);
+    size_t targetsBytes = header.numEdges * sizeof(VertexT);
+    size_t weightsBytes = header.numEdges * sizeof(WeightT);
+    if (header.fileSize != file->size() || header.timesPos + weightsBytes != header.fileSize ||
+        header.offsetsPos + offsetsBytes > header.targetsPos ||
+        header.targetsPos + targetsBytes > header.costsPos ||
+        header.costsPos + weightsBytes > header.timesPos) {
+        return fail("truncated or inconsistent layout");
+    }
+
+    const char* base = file->data();
+    if (verifyArrays &&
+        (header.offsetsChecksum != snapshotChecksum(base + header.offsetsPos, offsetsBytes) ||
+         header.targetsChecksum != snapshotChecksum(base + header.targetsPos, targetsBytes) ||
+         header.costsChecksum != snapshotChecksum(base + header.costsPos, weightsBytes) ||
+         header.timesChecksum != snapshotChecksum(base + header.timesPos, weightsBytes))) {
+        return fail("array checksum mismatch");
+    }
+
+    typename graph<VertexT, WeightT>::CSR view;
+    view.numVertices = header.numVertices;
+    view.numEdges = header.numEdges;
+    view.offsets = reinterpret_cast<const uint64_t*>(base + header.offsetsPos);
+    view.targets = reinterpret_cast<const VertexT*>(base + header.targetsPos);
+    view.costs = reinterpret_cast<const WeightT*>(base + header.costsPos);
+    view.times = reinterpret_cast<const WeightT*>(base + header.timesPos);
+    file->adviseRandomAccess();
+    g.attachFrozen(view, file);
+    return true;
+}
+
+template<typename VertexT, typename WeightT>
+bool loadSnapshot(const string& filename, graph<VertexT, WeightT>& g, bool verifyArrays = false) {
+    auto file = make_shared<const MappedFile>(filename);
+    if (!file->isOpen()) {
+        cerr << "Error: Unable to open snapshot file " << filename << endl;
+        return false;
+    }
+    return attachSnapshot(file, filename, g, verifyArrays);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Threads kept for the parallel search (see parallel_pareto.h), so a query
+// does not pay for spawning and joining its workers. A pool of n runs a
+// job as job(0) .. job(n - 1): job(0) on the calling thread, the rest on
+// n - 1 threads that sleep between jobs and live as long as the pool.
+//
+// One job runs at a time. run() returns once every thread has finished
+// it, so the job may refer to the caller's locals.
+class WorkerPool {
+private:
+    vector<thread> threads;
+    mutex lock;
+    condition_variable wake; // a job was posted, or the pool is closing
+    condition_variable done; // the last worker finished the job
+    const function<void(int)>* job = nullptr;
+    uint64_t generation = 0; // jobs posted so far
+    int running = 0;         // workers still in the current job
+    bool closing = false;
+
+    void work(int t) {
+        uint64_t seen = 0;
+        while (true) {
+            const function<void(int)>* current;
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [&] { return closing || generation != seen; });
+                if (closing) {
+                    return;
+                }
+                seen = generation;
+                current = job;
+            }
+            (*current)(t);
+            lock_guard<mutex> guard(lock);
+            if (--running == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit WorkerPool(int numThreads = 1) {
+        for (int t = 1; t < numThreads; ++t) {
+            threads.emplace_back(&WorkerPool::work, this, t);
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            closing = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    int size() const {
+        return int(threads.size()) + 1;
+    }
+
+    void run(const function<void(int)>& f) {
+        if (threads.empty()) {
+            f(0);
+            return;
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            job = &f;
+            running = int(threads.size());
+            ++generation;
+        }
+        wake.notify_all();
+        f(0);
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [&] { return running == 0; });
+    }
+};